@@ -52,6 +52,9 @@ static int defSuspendUnit = AlarmDialog::SuspendInMinutes;
 static const char s_fdo_notifications_service[] = "org.freedesktop.Notifications";
 static const char s_fdo_notifications_path[] = "/org/freedesktop/Notifications";
 
+// delay for writing the reminders to the config, so that bursts of changes are saved at once
+static const int s_saveDelay = 2000; // ms
+
 class ReminderTreeItem : public QTreeWidgetItem
 {
 public:
@@ -74,12 +77,6 @@ public:
     bool mNotified = false;
 };
 
-struct ConfItem {
-    QString uid;
-    QUrl akonadiUrl;
-    QDateTime remindAt;
-};
-
 bool ReminderTreeItem::operator<(const QTreeWidgetItem &other) const
 {
     switch (treeWidget()->sortColumn()) {
@@ -100,6 +97,7 @@ AlarmDialog::AlarmDialog(const Akonadi::ETMCalendar::Ptr &calendar, QWidget *par
     : QDialog(parent, Qt::WindowStaysOnTopHint)
     , mCalendar(calendar)
     , mSuspendTimer(this)
+    , mSaveTimer(this)
 {
     // User1 => Edit...
     // User2 => Dismiss All
@@ -107,7 +105,7 @@ AlarmDialog::AlarmDialog(const Akonadi::ETMCalendar::Ptr &calendar, QWidget *par
     //    Ok => Suspend
 
     if (calendar) {
-        connect(calendar.data(), &Akonadi::ETMCalendar::calendarChanged, this, &AlarmDialog::slotCalendarChanged);
+        calendar->registerObserver(this);
         Akonadi::IncidenceChanger *changer = calendar->incidenceChanger();
         changer->setShowDialogsOnError(false);
     }
@@ -263,6 +261,10 @@ AlarmDialog::AlarmDialog(const Akonadi::ETMCalendar::Ptr &calendar, QWidget *par
 
     connect(&mSuspendTimer, &QTimer::timeout, this, &AlarmDialog::wakeUp);
 
+    mSaveTimer.setSingleShot(true);
+    mSaveTimer.setInterval(s_saveDelay);
+    connect(&mSaveTimer, &QTimer::timeout, this, &AlarmDialog::slotSave);
+
     connect(mOkButton, &QPushButton::clicked, this, &AlarmDialog::slotOk);
     connect(mUser1Button, &QPushButton::clicked, this, &AlarmDialog::slotUser1);
     connect(mUser2Button, &QPushButton::clicked, this, &AlarmDialog::slotUser2);
@@ -280,22 +282,20 @@ AlarmDialog::AlarmDialog(const Akonadi::ETMCalendar::Ptr &calendar, QWidget *par
 
 AlarmDialog::~AlarmDialog()
 {
+    // flush pending changes
+    if (mSaveTimer.isActive()) {
+        slotSave();
+    }
+    if (mCalendar) {
+        mCalendar->unregisterObserver(this);
+    }
+    mReminderByItemId.clear();
     mIncidenceTree->clear();
 }
 
-ReminderTreeItem *AlarmDialog::searchByItem(const Akonadi::Item &incidence)
+ReminderTreeItem *AlarmDialog::searchByItem(const Akonadi::Item &incidence) const
 {
-    ReminderTreeItem *found = nullptr;
-    QTreeWidgetItemIterator it(mIncidenceTree);
-    while (*it) {
-        auto item = static_cast<ReminderTreeItem *>(*it);
-        if (item->mIncidence == incidence) {
-            found = item;
-            break;
-        }
-        ++it;
-    }
-    return found;
+    return mReminderByItemId.value(incidence.id());
 }
 
 static QString cleanSummary(const QString &summary)
@@ -310,6 +310,7 @@ void AlarmDialog::addIncidence(const Akonadi::Item &incidenceitem, const QDateTi
     ReminderTreeItem *item = searchByItem(incidenceitem);
     if (!item) {
         item = new ReminderTreeItem(incidenceitem, mIncidenceTree);
+        mReminderByItemId.insert(incidenceitem.id(), item);
     }
     item->mNotified = false;
     item->mHappening = QDateTime();
@@ -345,7 +346,7 @@ void AlarmDialog::addIncidence(const Akonadi::Item &incidenceitem, const QDateTi
 
     mIncidenceTree->setCurrentItem(item);
     showDetails(item);
-    slotSave();
+    scheduleSave();
 }
 
 void AlarmDialog::resetSuspend()
@@ -419,8 +420,6 @@ void AlarmDialog::dismissAll()
 
 void AlarmDialog::dismiss(const ReminderList &selections)
 {
-    QList<Akonadi::Item::Id> ids;
-    ids.reserve(selections.count());
     for (ReminderList::const_iterator it = selections.constBegin(); it != selections.constEnd(); ++it) {
         qCDebug(KOALARMCLIENT_LOG) << "removing " << CalendarSupport::incidence((*it)->mIncidence)->summary();
         if (mIncidenceTree->itemBelow(*it)) {
@@ -429,11 +428,11 @@ void AlarmDialog::dismiss(const ReminderList &selections)
             mIncidenceTree->setCurrentItem(mIncidenceTree->itemAbove(*it));
         }
         mIncidenceTree->removeItemWidget(*it, 0);
-        ids.append((*it)->mIncidence.id());
+        mReminderByItemId.remove((*it)->mIncidence.id());
         delete *it;
     }
 
-    removeFromConfig(ids);
+    scheduleSave();
 }
 
 void AlarmDialog::edit()
@@ -504,7 +503,7 @@ void AlarmDialog::suspend()
 
     // save suspended alarms too so they can be restored on restart
     // kolab/issue4108
-    slotSave();
+    scheduleSave();
 
     setTimer();
     if (activeCount() == 0) {
@@ -701,24 +700,38 @@ void AlarmDialog::slotDBusNotificationsPropertiesChanged(const QString &interfac
     }
 }
 
+void AlarmDialog::scheduleSave()
+{
+    if (!mSaveTimer.isActive()) {
+        mSaveTimer.start();
+    }
+}
+
 void AlarmDialog::slotSave()
 {
+    mSaveTimer.stop();
+
     KSharedConfig::Ptr config = KSharedConfig::openConfig();
     KConfigGroup generalConfig(config, "General");
+    const int oldNumReminders = generalConfig.readEntry("Reminders", 0);
     int numReminders = 0;
 
     QTreeWidgetItemIterator it(mIncidenceTree);
     while (*it) {
         auto item = static_cast<ReminderTreeItem *>(*it);
         KConfigGroup incidenceConfig(config, QStringLiteral("Incidence-%1").arg(numReminders + 1));
-
-        Incidence::Ptr incidence = CalendarSupport::incidence(item->mIncidence);
+        incidenceConfig.deleteEntry("UID");
         incidenceConfig.writeEntry("AkonadiUrl", item->mIncidence.url());
         incidenceConfig.writeEntry("RemindAt", item->mRemindAt);
         ++numReminders;
         ++it;
     }
 
+    // remove the groups of dismissed reminders
+    for (int i = numReminders + 1; i <= oldNumReminders; ++i) {
+        config->deleteGroup(QStringLiteral("Incidence-%1").arg(i));
+    }
+
     generalConfig.writeEntry("Reminders", numReminders);
     mRect = geometry();
     generalConfig.writeEntry("Position", mRect.topLeft());
@@ -727,6 +740,7 @@ void AlarmDialog::slotSave()
     generalConfig.writeEntry("DefaultSuspendUnit", defSuspendUnit);
 
     config->sync();
+    ++mSaveCount;
 }
 
 AlarmDialog::ReminderList AlarmDialog::selectedItems() const
@@ -743,7 +757,7 @@ AlarmDialog::ReminderList AlarmDialog::selectedItems() const
     return list;
 }
 
-int AlarmDialog::activeCount()
+int AlarmDialog::activeCount() const
 {
     int count = 0;
     QTreeWidgetItemIterator it(mIncidenceTree);
@@ -757,6 +771,16 @@ int AlarmDialog::activeCount()
     return count;
 }
 
+int AlarmDialog::suspendedCount() const
+{
+    return mReminderByItemId.count() - activeCount();
+}
+
+int AlarmDialog::saveCount() const
+{
+    return mSaveCount;
+}
+
 void AlarmDialog::closeEvent(QCloseEvent *)
 {
     // note, this is on application close (not window hide)
@@ -877,30 +901,33 @@ QDateTime AlarmDialog::triggerDateForIncidence(const Incidence::Ptr &incidence,
     return result;
 }
 
-void AlarmDialog::slotCalendarChanged()
+void AlarmDialog::calendarIncidenceChanged(const Incidence::Ptr &incidence)
 {
-    KCalendarCore::Incidence::List incidences = mCalendar->incidences();
-    const Akonadi::Item::List items = mCalendar->itemList(incidences);
-    Akonadi::Item::List::ConstIterator end(items.constEnd());
-    for (Akonadi::Item::List::ConstIterator it = items.constBegin(); it != end; ++it) {
-        ReminderTreeItem *item = searchByItem(*it);
-
-        if (item) {
-            Incidence::Ptr incidence = CalendarSupport::incidence(*it);
-            QString displayStr;
-
-            // Yes, alarms can be empty, if someone edited the incidence and removed all alarms
-            if (!incidence->alarms().isEmpty()) {
-                const auto dateTime = triggerDateForIncidence(incidence, item->mRemindAt, displayStr);
-                const QString summary = cleanSummary(incidence->summary());
-
-                if (displayStr != item->text(1) || summary != item->text(0) || item->mHappening != dateTime) {
-                    item->setText(1, displayStr);
-                    item->setText(0, summary);
-                    item->mHappening = dateTime;
-                }
-            }
-        }
+    if (mReminderByItemId.isEmpty()) {
+        return;
+    }
+
+    ReminderTreeItem *item = searchByItem(mCalendar->item(incidence));
+    if (item) {
+        updateReminder(item, incidence);
+    }
+}
+
+void AlarmDialog::updateReminder(ReminderTreeItem *item, const Incidence::Ptr &incidence)
+{
+    // Yes, alarms can be empty, if someone edited the incidence and removed all alarms
+    if (incidence->alarms().isEmpty()) {
+        return;
+    }
+
+    QString displayStr;
+    const auto dateTime = triggerDateForIncidence(incidence, item->mRemindAt, displayStr);
+    const QString summary = cleanSummary(incidence->summary());
+
+    if (displayStr != item->text(1) || summary != item->text(0) || item->mHappening != dateTime) {
+        item->setText(1, displayStr);
+        item->setText(0, summary);
+        item->mHappening = dateTime;
     }
 }
 
@@ -979,48 +1006,6 @@ bool AlarmDialog::openIncidenceEditorNG(const Akonadi::Item &item)
     }
 }
 
-void AlarmDialog::removeFromConfig(const QList<Akonadi::Item::Id> &ids)
-{
-    KSharedConfig::Ptr config = KSharedConfig::openConfig();
-    KConfigGroup genGroup(config, "General");
-
-    const int oldNumReminders = genGroup.readEntry("Reminders", 0);
-
-    QVector<ConfItem> newReminders;
-    // Delete everything
-    for (int i = 1; i <= oldNumReminders; ++i) {
-        const QString group(QStringLiteral("Incidence-%1").arg(i));
-        KConfigGroup incGroup(config, group);
-        const QString uid = incGroup.readEntry("UID");
-        const QDateTime remindAtDate = incGroup.readEntry("RemindAt", QDateTime());
-        const QUrl akonadiUrl(incGroup.readEntry("AkonadiUrl"));
-        const Akonadi::Item::Id id = Akonadi::Item::fromUrl(akonadiUrl).id();
-        if (!ids.contains(id)) {
-            ConfItem ci;
-            ci.akonadiUrl = akonadiUrl;
-            ci.remindAt = remindAtDate;
-            ci.uid = uid;
-            newReminders.append(ci);
-        }
-        config->deleteGroup(group);
-    }
-
-    const int newRemindersCount(newReminders.count());
-    genGroup.writeEntry("Reminders", newRemindersCount);
-
-    // Write everything except those which have an uid we don't want
-    for (int i = 0; i < newRemindersCount; ++i) {
-        const QString group(QStringLiteral("Incidence-%1").arg(i + 1));
-        KConfigGroup incGroup(config, group);
-        const ConfItem conf = newReminders.at(i);
-        incGroup.writeEntry("UID", conf.uid);
-        incGroup.writeEntry("RemindAt", conf.remindAt);
-        incGroup.writeEntry("AkonadiUrl", conf.akonadiUrl);
-        incGroup.sync();
-    }
-    genGroup.sync();
-}
-
 bool AlarmDialog::grabFocus()
 {
     KSharedConfig::Ptr config = KSharedConfig::openConfig();
@@ -10,6 +10,7 @@
 #include <Akonadi/Calendar/ETMCalendar>
 
 #include <QDialog>
+#include <QHash>
 #include <QTimer>
 
 class ReminderTreeItem;
@@ -30,7 +31,7 @@ class QSpinBox;
 class QTreeWidget;
 class QTreeWidgetItem;
 
-class AlarmDialog : public QDialog
+class AlarmDialog : public QDialog, public Akonadi::ETMCalendar::CalendarObserver
 {
     Q_OBJECT
 
@@ -52,6 +53,20 @@ public:
     void addIncidence(const Akonadi::Item &incidence, const QDateTime &reminderAt, const QString &displayText);
     void eventNotification();
 
+    /** Returns the number of reminders that are not suspended. */
+    Q_REQUIRED_RESULT int activeCount() const;
+    /** Returns the number of suspended reminders. */
+    Q_REQUIRED_RESULT int suspendedCount() const;
+    /** Returns how often the reminders were written to the config file. */
+    Q_REQUIRED_RESULT int saveCount() const;
+
+    /**
+     * Reimplemented from Akonadi::ETMCalendar::CalendarObserver.
+     * If an incidence changed, for example in korg, we must update
+     * the date and summary shown in the list view of its reminder.
+     */
+    void calendarIncidenceChanged(const KCalendarCore::Incidence::Ptr &incidence) override;
+
 public Q_SLOTS:
     void slotOk(); // suspend
     void slotUser1(); // edit
@@ -71,12 +86,6 @@ public Q_SLOTS:
     void accept() override;
     void reject() override;
 
-    /**
-       If an incidence changed, for example in korg, we must update
-       the date and summary shown in the list view.
-    */
-    void slotCalendarChanged();
-
 Q_SIGNALS:
     void reminderCount(int count);
 
@@ -95,8 +104,8 @@ private:
 
     static Q_REQUIRED_RESULT QDateTime triggerDateForIncidence(const KCalendarCore::Incidence::Ptr &inc, const QDateTime &reminderAt, QString &displayStr);
 
-    // Removes each Incidence-X group that has one of the specified uids
-    void removeFromConfig(const QList<Akonadi::Item::Id> &);
+    // Saves the reminders after a short delay, coalescing bursts of changes
+    void scheduleSave();
 
     // Opens through dbus, @deprecated
     Q_REQUIRED_RESULT bool openIncidenceEditorThroughKOrganizer(const KCalendarCore::Incidence::Ptr &incidence);
@@ -104,10 +113,10 @@ private:
     // opens directly
     Q_REQUIRED_RESULT bool openIncidenceEditorNG(const Akonadi::Item &incidence);
 
-    ReminderTreeItem *searchByItem(const Akonadi::Item &incidence);
+    ReminderTreeItem *searchByItem(const Akonadi::Item &incidence) const;
+    void updateReminder(ReminderTreeItem *item, const KCalendarCore::Incidence::Ptr &incidence);
     void setTimer();
     void dismiss(const ReminderList &selections);
-    Q_REQUIRED_RESULT int activeCount();
     Q_REQUIRED_RESULT ReminderList selectedItems() const;
     void toggleDetails(QTreeWidgetItem *item);
     void showDetails(QTreeWidgetItem *item);
@@ -115,12 +124,16 @@ private:
 
     Akonadi::ETMCalendar::Ptr mCalendar;
     QTreeWidget *mIncidenceTree = nullptr;
+    /** the reminders in mIncidenceTree, keyed by their item id */
+    QHash<Akonadi::Item::Id, ReminderTreeItem *> mReminderByItemId;
     CalendarSupport::IncidenceViewer *mDetailView = nullptr;
 
     QRect mRect;
     QSpinBox *mSuspendSpin = nullptr;
     QComboBox *mSuspendUnit = nullptr;
     QTimer mSuspendTimer;
+    QTimer mSaveTimer;
+    int mSaveCount = 0;
     QTreeWidgetItem *mLastItem = nullptr;
     QPushButton *mUser1Button = nullptr;
     QPushButton *mUser2Button = nullptr;
@@ -13,7 +13,10 @@
 #include "koalarmclient_debug.h"
 #include "korgacadaptor.h"
 
+#include <Akonadi/Calendar/BlockAlarmsAttribute>
 #include <Akonadi/EntityTreeModel>
+#include <Akonadi/ItemFetchJob>
+#include <Akonadi/ItemFetchScope>
 #include <Akonadi/ServerManager>
 
 #include <CalendarSupport/Utils>
@@ -25,8 +28,51 @@
 #include <QApplication>
 #include <QDBusConnection>
 
+#include <utility>
+
 using namespace KCalendarCore;
 
+// Upper bound for sleeping between two checks. Guards against wall clock
+// changes, which do not affect the monotonic timer.
+static const int s_maxCheckInterval = 60 * 60 * 1000; // one hour, in ms
+
+// Reminders for alarms older than this are dropped, and such alarms are not
+// even evaluated when catching up after a long suspend.
+static const int s_maxReminderAge = 10; // in days
+
+// Number of due incidences evaluated per event loop iteration
+static const int s_checkSliceSize = 50;
+
+// Number of upcoming triggers remembered across restarts, see saveLastCheckTime()
+static const int s_maxPersistedTriggers = 100;
+
+/**
+ * Returns the first time one of the alarms of @p incidence triggers after @p from, up to @p until,
+ * or an invalid time if none does. @p displayText is set to the text of the last triggered alarm.
+ */
+static QDateTime alarmTriggered(const Incidence::Ptr &incidence,
+                                const QDateTime &from,
+                                const QDateTime &until,
+                                const Akonadi::BlockAlarmsAttribute *blocked,
+                                QString &displayText)
+{
+    QDateTime first;
+    const Alarm::List alarms = incidence->alarms();
+    for (const Alarm::Ptr &alarm : alarms) {
+        if (!alarm->enabled() || (blocked && blocked->isAlarmTypeBlocked(alarm->type()))) {
+            continue;
+        }
+        const QDateTime trigger = alarm->nextTime(from);
+        if (trigger.isValid() && trigger <= until) {
+            if (!first.isValid() || trigger < first) {
+                first = trigger;
+            }
+            displayText = alarm->text();
+        }
+    }
+    return first;
+}
+
 KOAlarmClient::KOAlarmClient(QObject *parent)
     : QObject(parent)
 {
@@ -58,16 +104,28 @@ KOAlarmClient::KOAlarmClient(QObject *parent)
     }
 
     KConfigGroup alarmGroup(KSharedConfig::openConfig(), "Alarms");
-    const int interval = alarmGroup.readEntry("Interval", 60);
-    qCDebug(KOALARMCLIENT_LOG) << "KOAlarmClient check interval:" << interval << "seconds.";
     mLastChecked = alarmGroup.readEntry("CalendarsLastChecked", QDateTime::currentDateTime().addDays(-9));
 
-    mCheckTimer.start(1000 * interval); // interval in seconds
+    // The check timer is armed for the next alarm trigger only, see armCheckTimer()
+    mCheckTimer.setSingleShot(true);
+    mCheckTimer.setTimerType(Qt::PreciseTimer);
     connect(qApp, &QApplication::commitDataRequest, this, &KOAlarmClient::slotCommitData);
+
+    // The monotonic timer does not advance while the system is suspended,
+    // so check for missed alarms as soon as it is resumed.
+    QDBusConnection::systemBus().connect(QStringLiteral("org.freedesktop.login1"),
+                                         QStringLiteral("/org/freedesktop/login1"),
+                                         QStringLiteral("org.freedesktop.login1.Manager"),
+                                         QStringLiteral("PrepareForSleep"),
+                                         this,
+                                         SLOT(slotPrepareForSleep(bool)));
 }
 
 KOAlarmClient::~KOAlarmClient()
 {
+    if (mCalendar) {
+        mCalendar->unregisterObserver(this);
+    }
     delete mDocker;
     delete mDialog;
 }
@@ -78,14 +136,107 @@ void KOAlarmClient::setupAkonadi()
     mCalendar = Akonadi::ETMCalendar::Ptr(new Akonadi::ETMCalendar(mimeTypes));
     mCalendar->setObjectName(QStringLiteral("KOrgac's calendar"));
     mETM = mCalendar->entityTreeModel();
+    mCalendar->registerObserver(this);
+    mPopulationElapsed.start();
 
     connect(&mCheckTimer, &QTimer::timeout, this, &KOAlarmClient::checkAlarms);
     connect(mETM, &Akonadi::EntityTreeModel::collectionPopulated, this, &KOAlarmClient::deferredInit);
     connect(mETM, &Akonadi::EntityTreeModel::collectionTreeFetched, this, &KOAlarmClient::deferredInit);
 
+    startEarlyCheck();
     checkAlarms();
 }
 
+void KOAlarmClient::startEarlyCheck()
+{
+    // Populating the whole calendar takes a while on big calendars. Until it
+    // is done, fetch only the items of the reminders that were active when
+    // quitting, and of the alarms that were known to be coming up next.
+    Akonadi::Item::List items;
+
+    KConfigGroup genGroup(KSharedConfig::openConfig(), "General");
+    const int numReminders = genGroup.readEntry("Reminders", 0);
+    for (int i = 1; i <= numReminders; ++i) {
+        const KConfigGroup incGroup(KSharedConfig::openConfig(), QStringLiteral("Incidence-%1").arg(i));
+        const QUrl url(incGroup.readEntry("AkonadiUrl"));
+        if (!url.isValid()) {
+            // reminders from old versions need the calendar to be migrated, see deferredInit()
+            mEarlyRemindAt.clear();
+            return;
+        }
+        const Akonadi::Item item = Akonadi::Item::fromUrl(url);
+        items.append(item);
+        mEarlyRemindAt.insert(item.id(), incGroup.readEntry("RemindAt", QDateTime()));
+    }
+
+    const QDateTime now = QDateTime::currentDateTime();
+    const KConfigGroup alarmGroup(KSharedConfig::openConfig(), "Alarms");
+    const QStringList triggers = alarmGroup.readEntry("UpcomingTriggers", QStringList());
+    for (const QString &entry : triggers) {
+        const int separator = entry.indexOf(QLatin1Char(':'));
+        const QDateTime trigger = QDateTime::fromSecsSinceEpoch(entry.mid(separator + 1).toLongLong());
+        if (separator <= 0 || trigger > now) {
+            continue;
+        }
+        const Akonadi::Item::Id id = entry.left(separator).toLongLong();
+        if (!mEarlyRemindAt.contains(id)) {
+            items.append(Akonadi::Item(id));
+        }
+    }
+
+    if (items.isEmpty()) {
+        return;
+    }
+
+    auto job = new Akonadi::ItemFetchJob(items, this);
+    job->fetchScope().fetchFullPayload();
+    job->fetchScope().setAncestorRetrieval(Akonadi::ItemFetchScope::Parent);
+    // items may have been deleted since they were persisted
+    job->fetchScope().setIgnoreRetrievalErrors(true);
+    connect(job, &Akonadi::ItemFetchJob::result, this, &KOAlarmClient::slotEarlyItemsFetched);
+}
+
+void KOAlarmClient::slotEarlyItemsFetched(KJob *job)
+{
+    const QHash<Akonadi::Item::Id, QDateTime> remindAt = std::exchange(mEarlyRemindAt, {});
+    if (job->error()) {
+        qCDebug(KOALARMCLIENT_LOG) << "Fetching reminders failed:" << job->errorString();
+        return;
+    }
+    if (mRemindersRestored) {
+        // the calendar was faster, it took care of everything already
+        return;
+    }
+    mRemindersRestored = true;
+
+    const QDateTime now = QDateTime::currentDateTime();
+    const QDateTime from = qMax(mLastChecked, now.addDays(-s_maxReminderAge));
+    const Akonadi::Item::List items = static_cast<Akonadi::ItemFetchJob *>(job)->items();
+    for (const Akonadi::Item &item : items) {
+        if (!CalendarSupport::hasIncidence(item)) {
+            continue;
+        }
+        const Incidence::Ptr incidence = CalendarSupport::incidence(item);
+        const auto it = remindAt.constFind(item.id());
+        if (it != remindAt.constEnd()) {
+            if (!incidence->alarms().isEmpty()) {
+                createReminder(item, it.value(), QString());
+            }
+            continue;
+        }
+
+        // Blocked alarms were not persisted, see saveLastCheckTime()
+        QString displayText;
+        const QDateTime trigger = alarmTriggered(incidence, from, now, nullptr, displayText);
+        if (trigger.isValid()) {
+            createReminder(item, now, displayText);
+            recordDisplayLag(trigger);
+            mEarlyReminders.insert(item.id());
+        }
+    }
+    qCDebug(KOALARMCLIENT_LOG) << "Startup check done for" << items.count() << "items";
+}
+
 void checkAllItems(KCheckableProxyModel *model, const QModelIndex &parent = QModelIndex())
 {
     const int rowCount = model->rowCount(parent);
@@ -106,10 +257,14 @@ void KOAlarmClient::deferredInit()
     }
 
     qCDebug(KOALARMCLIENT_LOG) << "Performing delayed initialization.";
+    if (mMetrics.populationTime < 0) {
+        mMetrics.populationTime = mPopulationElapsed.elapsed();
+    }
 
-    // load reminders that were active when quitting
+    // load reminders that were active when quitting, unless the startup check did already
     KConfigGroup genGroup(KSharedConfig::openConfig(), "General");
-    const int numReminders = genGroup.readEntry("Reminders", 0);
+    const int numReminders = mRemindersRestored ? 0 : genGroup.readEntry("Reminders", 0);
+    mRemindersRestored = true;
 
     for (int i = 1; i <= numReminders; ++i) {
         const QString group(QStringLiteral("Incidence-%1").arg(i));
@@ -140,6 +295,7 @@ void KOAlarmClient::deferredInit()
     checkAllItems(checkableModel);
 
     // Now that everything is set up, a first check for reminders can be performed.
+    rebuildSchedule();
     checkAlarms();
 }
 
@@ -176,29 +332,203 @@ void KOAlarmClient::checkAlarms()
     KConfigGroup cfg(KSharedConfig::openConfig(), "General");
 
     if (!cfg.readEntry("Enabled", true)) {
+        // look again later, reminders may have been enabled in the meantime
+        mCheckTimer.start(s_maxCheckInterval);
         return;
     }
 
     // We do not want to miss any reminders, so don't perform check unless
-    // the collections are available and populated.
+    // the collections are available and populated. deferredInit() checks
+    // again as soon as they are.
     if (!collectionsAvailable()) {
         qCDebug(KOALARMCLIENT_LOG) << "Collections are not available; aborting check.";
         return;
     }
 
-    const QDateTime from = mLastChecked.addSecs(1);
-    mLastChecked = QDateTime::currentDateTime();
+    // A check that is already running picks up everything that became due meanwhile.
+    const bool running = mCheckingUntil.isValid();
+    mCheckingUntil = QDateTime::currentDateTime();
+    if (!running) {
+        qCDebug(KOALARMCLIENT_LOG) << "Check:" << mLastChecked.toString() << " -" << mCheckingUntil.toString();
+        mCheckElapsed.start();
+        processDueAlarms();
+    }
+}
+
+void KOAlarmClient::processDueAlarms()
+{
+    // Don't look further back than reminders are kept, so that catching up after
+    // a long suspend doesn't expand weeks of recurrences.
+    const QDateTime from = qMax(mLastChecked, mCheckingUntil.addDays(-s_maxReminderAge));
+
+    for (int i = 0; i < s_checkSliceSize; ++i) {
+        if (mTriggerQueue.isEmpty() || mTriggerQueue.firstKey() > mCheckingUntil) {
+            finishCheck();
+            return;
+        }
+
+        const QString identifier = mTriggerQueue.first();
+        unscheduleIncidence(identifier);
+        const Incidence::Ptr incidence = mCalendar->instance(identifier);
+        if (incidence) {
+            mMetrics.alarmsEvaluated += incidence->alarms().count();
+            remindOfIncidence(incidence, from, mCheckingUntil);
+            scheduleIncidence(incidence, mCheckingUntil);
+        }
+    }
+
+    // More incidences are due, continue on the next event loop iteration so
+    // that the reminder dialog and D-Bus calls stay responsive.
+    QTimer::singleShot(0, this, &KOAlarmClient::processDueAlarms);
+}
+
+void KOAlarmClient::finishCheck()
+{
+    mLastChecked = mCheckingUntil;
+    mCheckingUntil = QDateTime();
+    mEarlyReminders.clear();
+
+    ++mMetrics.checks;
+    mMetrics.lastCheckAlarms = std::exchange(mMetrics.alarmsEvaluated, 0);
+    mMetrics.lastCheckLatency = mCheckElapsed.elapsed();
+    mMetrics.maxCheckLatency = qMax(mMetrics.maxCheckLatency, mMetrics.lastCheckLatency);
+    if (mRemindersCreated) {
+        mRemindersCreated = false;
+        saveLastCheckTime();
+    }
+    armCheckTimer();
+}
 
-    qCDebug(KOALARMCLIENT_LOG) << "Check:" << from.toString() << " -" << mLastChecked.toString();
+void KOAlarmClient::remindOfIncidence(const Incidence::Ptr &incidence, const QDateTime &from, const QDateTime &until)
+{
+    const Akonadi::Item item = mCalendar->item(incidence);
+    const auto *blocked = mCalendar->collection(item.storageCollectionId()).attribute<Akonadi::BlockAlarmsAttribute>();
+
+    // All occurrences of a recurring incidence missed in the checked interval
+    // collapse into a single reminder.
+    QString displayText;
+    const QDateTime trigger = alarmTriggered(incidence, from, until, blocked, displayText);
+    if (!trigger.isValid()) {
+        return;
+    }
 
-    const Alarm::List alarms = mCalendar->alarms(from, mLastChecked, true /* exclude blocked alarms */);
+    // already shown by the startup check, see slotEarlyItemsFetched()
+    if (mEarlyReminders.remove(item.id())) {
+        return;
+    }
 
+    createReminder(item, until, displayText);
+    recordDisplayLag(trigger);
+    mRemindersCreated = true;
+}
+
+void KOAlarmClient::recordDisplayLag(const QDateTime &trigger)
+{
+    mMetrics.lastDisplayLag = trigger.msecsTo(QDateTime::currentDateTime());
+    mMetrics.maxDisplayLag = qMax(mMetrics.maxDisplayLag, mMetrics.lastDisplayLag);
+}
+
+QDateTime KOAlarmClient::nextTrigger(const Incidence::Ptr &incidence, const QDateTime &after) const
+{
+    // completed to-dos don't remind anymore
+    if (incidence->type() == Incidence::TypeTodo && incidence.staticCast<Todo>()->isCompleted()) {
+        return {};
+    }
+
+    QDateTime next;
+    const Alarm::List alarms = incidence->alarms();
     for (const Alarm::Ptr &alarm : alarms) {
-        const QString uid = alarm->customProperty("ETMCalendar", "parentUid");
-        const Akonadi::Item::Id id = mCalendar->item(uid).id();
-        const Akonadi::Item item = mCalendar->item(id);
+        if (!alarm->enabled()) {
+            continue;
+        }
+        // Alarm::nextTime() takes recurrences and alarm repetitions into account
+        const QDateTime trigger = alarm->nextTime(after);
+        if (trigger.isValid() && (!next.isValid() || trigger < next)) {
+            next = trigger;
+        }
+    }
+    return next;
+}
+
+QDateTime KOAlarmClient::scheduleStart() const
+{
+    return qMax(mLastChecked, QDateTime::currentDateTime().addDays(-s_maxReminderAge));
+}
+
+void KOAlarmClient::scheduleIncidence(const Incidence::Ptr &incidence, const QDateTime &after)
+{
+    const QString identifier = incidence->instanceIdentifier();
+    unscheduleIncidence(identifier);
+
+    const QDateTime trigger = nextTrigger(incidence, after);
+    if (trigger.isValid()) {
+        mTriggerQueue.insert(trigger, identifier);
+        mTriggerByIncidence.insert(identifier, trigger);
+    }
+}
+
+void KOAlarmClient::unscheduleIncidence(const QString &instanceIdentifier)
+{
+    const auto it = mTriggerByIncidence.find(instanceIdentifier);
+    if (it != mTriggerByIncidence.end()) {
+        mTriggerQueue.remove(it.value(), instanceIdentifier);
+        mTriggerByIncidence.erase(it);
+    }
+}
+
+void KOAlarmClient::rebuildSchedule()
+{
+    mTriggerQueue.clear();
+    mTriggerByIncidence.clear();
+
+    const QDateTime after = scheduleStart();
+    const Incidence::List incidences = mCalendar->rawIncidences();
+    for (const Incidence::Ptr &incidence : incidences) {
+        scheduleIncidence(incidence, after);
+    }
+    qCDebug(KOALARMCLIENT_LOG) << mTriggerQueue.count() << "incidences with upcoming alarms";
+}
+
+void KOAlarmClient::armCheckTimer()
+{
+    if (mTriggerQueue.isEmpty()) {
+        // nothing to remind of, sleep until the calendar changes
+        mCheckTimer.stop();
+        return;
+    }
 
-        createReminder(item, mLastChecked, alarm->text());
+    const qint64 msecs = QDateTime::currentDateTime().msecsTo(mTriggerQueue.firstKey());
+    mCheckTimer.start(static_cast<int>(qBound<qint64>(0, msecs, s_maxCheckInterval)));
+}
+
+void KOAlarmClient::calendarIncidenceAdded(const Incidence::Ptr &incidence)
+{
+    calendarIncidenceChanged(incidence);
+}
+
+void KOAlarmClient::calendarIncidenceChanged(const Incidence::Ptr &incidence)
+{
+    scheduleIncidence(incidence, scheduleStart());
+    // alarms are only checked once the calendar is fully populated
+    if (collectionsAvailable()) {
+        armCheckTimer();
+    }
+}
+
+void KOAlarmClient::calendarIncidenceDeleted(const Incidence::Ptr &incidence, const Calendar *calendar)
+{
+    Q_UNUSED(calendar)
+    unscheduleIncidence(incidence->instanceIdentifier());
+    if (collectionsAvailable()) {
+        armCheckTimer();
+    }
+}
+
+void KOAlarmClient::slotPrepareForSleep(bool sleep)
+{
+    if (!sleep && mCalendar) {
+        qCDebug(KOALARMCLIENT_LOG) << "System resumed, checking for missed alarms.";
+        checkAlarms();
     }
 }
 
@@ -208,7 +538,7 @@ void KOAlarmClient::createReminder(const Akonadi::Item &aitem, const QDateTime &
         return;
     }
 
-    if (remindAtDate.addDays(10) < mLastChecked) {
+    if (remindAtDate.addDays(s_maxReminderAge) < mLastChecked) {
         // ignore reminders more than 10 days old
         return;
     }
@@ -217,7 +547,6 @@ void KOAlarmClient::createReminder(const Akonadi::Item &aitem, const QDateTime &
 
     mDialog->addIncidence(aitem, remindAtDate, displayText);
     mDialog->wakeUp();
-    saveLastCheckTime();
 }
 
 void KOAlarmClient::showReminder()
@@ -250,7 +579,31 @@ void KOAlarmClient::saveLastCheckTime()
 {
     KConfigGroup cg(KSharedConfig::openConfig(), "Alarms");
     cg.writeEntry("CalendarsLastChecked", mLastChecked);
+    if (mCalendar && collectionsAvailable()) {
+        cg.writeEntry("UpcomingTriggers", upcomingTriggers());
+    }
     KSharedConfig::openConfig()->sync();
+    ++mMetrics.configWrites;
+}
+
+QStringList KOAlarmClient::upcomingTriggers() const
+{
+    // Entries are "<item id>:<trigger in seconds since epoch>", used by
+    // startEarlyCheck() to remind before the calendar is populated.
+    QStringList triggers;
+    for (auto it = mTriggerQueue.cbegin(), end = mTriggerQueue.cend(); it != end && triggers.count() < s_maxPersistedTriggers; ++it) {
+        const Incidence::Ptr incidence = mCalendar->instance(it.value());
+        if (!incidence) {
+            continue;
+        }
+        const Akonadi::Item item = mCalendar->item(incidence);
+        const auto *blocked = mCalendar->collection(item.storageCollectionId()).attribute<Akonadi::BlockAlarmsAttribute>();
+        if (blocked && blocked->isAlarmTypeBlocked(Alarm::Display)) {
+            continue;
+        }
+        triggers.append(QStringLiteral("%1:%2").arg(item.id()).arg(it.key().toSecsSinceEpoch()));
+    }
+    return triggers;
 }
 
 void KOAlarmClient::quit()
@@ -281,34 +634,49 @@ QString KOAlarmClient::dumpDebug() const
 
 QStringList KOAlarmClient::dumpAlarms() const
 {
-    const QDateTime start = QDateTime(QDate::currentDate(), QTime(0, 0), Qt::LocalTime);
-    const QDateTime end = start.addDays(1).addSecs(-1);
+    const QDateTime start = QDateTime::currentDateTime();
+    const QDateTime end = QDateTime(QDate::currentDate().addDays(1), QTime(0, 0), Qt::LocalTime).addSecs(-1);
 
+    // The trigger queue holds the next trigger of every incidence, no need to
+    // query the whole calendar.
     QStringList lst;
-    const Alarm::List alarms = mCalendar->alarms(start, end);
-    lst.reserve(1 + (alarms.isEmpty() ? 1 : alarms.count()));
     // Don't translate, this is for debugging purposes.
     lst << QStringLiteral("dumpAlarms() from ") + start.toString() + QLatin1String(" to ") + end.toString();
 
-    if (alarms.isEmpty()) {
-        lst << QStringLiteral("No alarm found.");
-    } else {
-        for (const Alarm::Ptr &alarm : alarms) {
-            const QString uid = alarm->customProperty("ETMCalendar", "parentUid");
-            const Akonadi::Item::Id id = mCalendar->item(uid).id();
-            const Akonadi::Item item = mCalendar->item(id);
-
-            const Incidence::Ptr incidence = CalendarSupport::incidence(item);
-            const QString summary = incidence->summary();
-
-            const QDateTime time = incidence->dateTime(Incidence::RoleAlarm);
-            lst << QStringLiteral("%1: \"%2\" (alarm text \"%3\")").arg(time.toString(Qt::ISODate), summary, alarm->text());
+    const auto last = mTriggerQueue.upperBound(end);
+    for (auto it = mTriggerQueue.cbegin(); it != last; ++it) {
+        const Incidence::Ptr incidence = mCalendar->instance(it.value());
+        if (incidence) {
+            lst << QStringLiteral("%1: \"%2\"").arg(it.key().toString(Qt::ISODate), incidence->summary());
         }
     }
 
+    if (lst.count() == 1) {
+        lst << QStringLiteral("No alarm found.");
+    }
+
     return lst;
 }
 
+QVariantMap KOAlarmClient::metrics() const
+{
+    // Don't translate, this is for debugging purposes. Times are in ms, -1 if not measured yet.
+    QVariantMap map;
+    map.insert(QStringLiteral("checks"), mMetrics.checks);
+    map.insert(QStringLiteral("lastCheckAlarmsEvaluated"), mMetrics.lastCheckAlarms);
+    map.insert(QStringLiteral("lastCheckLatency"), mMetrics.lastCheckLatency);
+    map.insert(QStringLiteral("maxCheckLatency"), mMetrics.maxCheckLatency);
+    map.insert(QStringLiteral("queuedTriggers"), mTriggerQueue.count());
+    map.insert(QStringLiteral("remindersPending"), mDialog ? mDialog->activeCount() : 0);
+    map.insert(QStringLiteral("remindersSuspended"), mDialog ? mDialog->suspendedCount() : 0);
+    map.insert(QStringLiteral("lastDisplayLag"), mMetrics.lastDisplayLag);
+    map.insert(QStringLiteral("maxDisplayLag"), mMetrics.maxDisplayLag);
+    map.insert(QStringLiteral("configWrites"), mMetrics.configWrites);
+    map.insert(QStringLiteral("reminderConfigWrites"), mDialog ? mDialog->saveCount() : 0);
+    map.insert(QStringLiteral("populationTime"), mMetrics.populationTime);
+    return map;
+}
+
 void KOAlarmClient::hide()
 {
     delete mDocker;
@@ -8,26 +8,39 @@
 #pragma once
 
 #include <Akonadi/Calendar/ETMCalendar>
+#include <Akonadi/Item>
 
 #include <QDateTime>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMultiMap>
+#include <QSet>
 #include <QSessionManager>
 #include <QTimer>
 class AlarmDialog;
 class AlarmDockWindow;
+class KJob;
 
 namespace Akonadi
 {
-class Item;
 class EntityTreeModel;
 }
 
-class KOAlarmClient : public QObject
+class KOAlarmClient : public QObject, public Akonadi::ETMCalendar::CalendarObserver
 {
     Q_OBJECT
 public:
     explicit KOAlarmClient(QObject *parent = nullptr);
     ~KOAlarmClient() override;
 
+    /**
+     * Reimplemented from Akonadi::ETMCalendar.
+     * They keep the queue of upcoming alarm triggers up to date.
+     */
+    void calendarIncidenceAdded(const KCalendarCore::Incidence::Ptr &incidence) override;
+    void calendarIncidenceChanged(const KCalendarCore::Incidence::Ptr &incidence) override;
+    void calendarIncidenceDeleted(const KCalendarCore::Incidence::Ptr &incidence, const KCalendarCore::Calendar *calendar) override;
+
     // DBUS interface
     void quit();
     void hide();
@@ -35,6 +48,7 @@ public:
     void forceAlarmCheck();
     Q_REQUIRED_RESULT QString dumpDebug() const;
     Q_REQUIRED_RESULT QStringList dumpAlarms() const;
+    Q_REQUIRED_RESULT QVariantMap metrics() const;
 
 public Q_SLOTS:
     void slotQuit();
@@ -43,25 +57,80 @@ Q_SIGNALS:
     void reminderCount(int);
     void saveAllSignal();
 
+private Q_SLOTS:
+    void slotPrepareForSleep(bool sleep);
+    void slotEarlyItemsFetched(KJob *job);
+
 private:
     void deferredInit();
     void checkAlarms();
+    /** Evaluates one slice of the incidences due until mCheckingUntil. */
+    void processDueAlarms();
+    void finishCheck();
+    /** Creates one reminder if any alarm of @p incidence triggered after @p from, up to @p until. */
+    void remindOfIncidence(const KCalendarCore::Incidence::Ptr &incidence, const QDateTime &from, const QDateTime &until);
+    void recordDisplayLag(const QDateTime &trigger);
     void setupAkonadi();
+    /** Reminds of persisted reminders and triggers without waiting for the calendar to be populated. */
+    void startEarlyCheck();
     void slotCommitData(QSessionManager &);
     void showReminder();
     Q_REQUIRED_RESULT bool dockerEnabled();
     Q_REQUIRED_RESULT bool collectionsAvailable() const;
     void createReminder(const Akonadi::Item &incidence, const QDateTime &dt, const QString &displayText);
     void saveLastCheckTime();
+    /** Returns the earliest queued triggers, in the format persisted by saveLastCheckTime(). */
+    Q_REQUIRED_RESULT QStringList upcomingTriggers() const;
     void createDialog();
 
+    /** Returns the next time after @p after one of the alarms of @p incidence triggers. */
+    Q_REQUIRED_RESULT QDateTime nextTrigger(const KCalendarCore::Incidence::Ptr &incidence, const QDateTime &after) const;
+    /** Returns the time after which newly scheduled triggers are considered. */
+    Q_REQUIRED_RESULT QDateTime scheduleStart() const;
+    /** (Re)queues the next trigger of @p incidence after @p after. */
+    void scheduleIncidence(const KCalendarCore::Incidence::Ptr &incidence, const QDateTime &after);
+    void unscheduleIncidence(const QString &instanceIdentifier);
+    void rebuildSchedule();
+    /** Arms mCheckTimer for the earliest queued trigger. */
+    void armCheckTimer();
+
     AlarmDockWindow *mDocker = nullptr; // the panel icon
     Akonadi::ETMCalendar::Ptr mCalendar;
     Akonadi::EntityTreeModel *mETM = nullptr;
 
     QDateTime mLastChecked;
+    /** end of the interval being checked, invalid if no check is running */
+    QDateTime mCheckingUntil;
+    bool mRemindersCreated = false;
+    /** reminders of the last session were restored, either early or by deferredInit() */
+    bool mRemindersRestored = false;
+    /** items reminded of by the startup check, not to be reminded of again by the first full check */
+    QSet<Akonadi::Item::Id> mEarlyReminders;
+    /** reminder times of the restored reminders, while they are being fetched */
+    QHash<Akonadi::Item::Id, QDateTime> mEarlyRemindAt;
     QTimer mCheckTimer;
 
+    /** upcoming alarm triggers, earliest first, mapped to incidence instance identifiers */
+    QMultiMap<QDateTime, QString> mTriggerQueue;
+    /** queued trigger of each incidence, keyed by instance identifier */
+    QHash<QString, QDateTime> mTriggerByIncidence;
+
     AlarmDialog *mDialog = nullptr;
+
+    /** counters reported by metrics(), times in ms */
+    struct Metrics {
+        int checks = 0;
+        int alarmsEvaluated = 0; // by the running check
+        int lastCheckAlarms = 0;
+        qint64 lastCheckLatency = -1;
+        qint64 maxCheckLatency = -1;
+        qint64 lastDisplayLag = -1;
+        qint64 maxDisplayLag = -1;
+        int configWrites = 0;
+        qint64 populationTime = -1;
+    };
+    Metrics mMetrics;
+    QElapsedTimer mCheckElapsed;
+    QElapsedTimer mPopulationElapsed;
 };
 
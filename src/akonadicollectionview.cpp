@@ -247,6 +247,25 @@ public:
         : QSortFilterProxyModel(parent)
         , mInitDefaultCalendar(false)
     {
+        // The decorations are cached per collection, drop them when the collection changes
+        connect(this, &QAbstractItemModel::dataChanged, this, [this](const QModelIndex &topLeft, const QModelIndex &bottomRight) {
+            for (int row = topLeft.row(); row <= bottomRight.row(); ++row) {
+                mDecorations.remove(CalendarSupport::collectionFromIndex(index(row, 0, topLeft.parent())).id());
+            }
+        });
+        connect(this, &QAbstractItemModel::rowsAboutToBeRemoved, this, [this]() {
+            mDecorations.clear();
+        });
+        connect(this, &QAbstractItemModel::modelReset, this, [this]() {
+            mDecorations.clear();
+        });
+        // ... or when its resource goes online or offline
+        connect(Akonadi::AgentManager::self(), &Akonadi::AgentManager::instanceOnline, this, [this](const Akonadi::AgentInstance &instance) {
+            resourceChanged(instance.identifier());
+        });
+        connect(Akonadi::AgentManager::self(), &Akonadi::AgentManager::instanceRemoved, this, [this](const Akonadi::AgentInstance &instance) {
+            resourceChanged(instance.identifier());
+        });
     }
 
     QVariant data(const QModelIndex &index, int role) const override
@@ -254,48 +273,107 @@ public:
         if (!index.isValid()) {
             return {};
         }
-        if (role == Qt::DecorationRole) {
-            const Akonadi::Collection collection = CalendarSupport::collectionFromIndex(index);
+        if (role == Qt::DecorationRole || role == Qt::FontRole || role == Qt::DisplayRole) {
+            const Decoration *decoration = this->decoration(index);
+            if (!decoration) {
+                return QSortFilterProxyModel::data(index, role);
+            }
+            if (role == Qt::DecorationRole) {
+                if (!decoration->icon.isNull()) {
+                    return decoration->icon;
+                }
+            } else if (role == Qt::FontRole) {
+                if (decoration->bold) {
+                    auto font = qvariant_cast<QFont>(QSortFilterProxyModel::data(index, Qt::FontRole));
+                    font.setBold(true);
+                    return font;
+                }
+            } else if (!decoration->label.isEmpty()) {
+                return decoration->label;
+            }
+        }
+
+        return QSortFilterProxyModel::data(index, role);
+    }
+
+    Qt::ItemFlags flags(const QModelIndex &index) const override
+    {
+        return Qt::ItemIsSelectable | QSortFilterProxyModel::flags(index);
+    }
+
+private:
+    struct Decoration {
+        QString resource;
+        QString label; // replaces the display name if not empty
+        QIcon icon;
+        bool bold = false;
+    };
+
+    const Decoration *decoration(const QModelIndex &index) const
+    {
+        const Akonadi::Collection collection = CalendarSupport::collectionFromIndex(index);
+        if (!collection.isValid()) {
+            return nullptr;
+        }
+
+        // The labels and fonts depend on the default calendar
+        const Akonadi::Collection::Id defaultCalendarId = CalendarSupport::KCalPrefs::instance()->defaultCalendarId();
+        if (defaultCalendarId != mDefaultCalendarId) {
+            mDecorations.clear();
+            mDefaultCalendarId = defaultCalendarId;
+        }
 
+        auto it = mDecorations.find(collection.id());
+        if (it == mDecorations.end()) {
+            Decoration decoration;
+            decoration.resource = collection.resource();
             if (hasCompatibleMimeTypes(collection)) {
                 if (collection.hasAttribute<Akonadi::EntityDisplayAttribute>()
                     && !collection.attribute<Akonadi::EntityDisplayAttribute>()->iconName().isEmpty()) {
-                    return collection.attribute<Akonadi::EntityDisplayAttribute>()->icon();
+                    decoration.icon = collection.attribute<Akonadi::EntityDisplayAttribute>()->icon();
                 }
             }
-        } else if (role == Qt::FontRole) {
-            const Akonadi::Collection collection = CalendarSupport::collectionFromIndex(index);
-            if (!collection.contentMimeTypes().isEmpty() && KOHelper::isStandardCalendar(collection.id())
+            if (!collection.contentMimeTypes().isEmpty() && collection.id() == defaultCalendarId
                 && collection.rights() & Akonadi::Collection::CanCreateItem) {
-                auto font = qvariant_cast<QFont>(QSortFilterProxyModel::data(index, Qt::FontRole));
-                font.setBold(true);
+                decoration.bold = true;
                 if (!mInitDefaultCalendar) {
                     mInitDefaultCalendar = true;
                     CalendarSupport::KCalPrefs::instance()->setDefaultCalendarId(collection.id());
                 }
-                return font;
             }
-        } else if (role == Qt::DisplayRole) {
-            const Akonadi::Collection collection = CalendarSupport::collectionFromIndex(index);
-            const Akonadi::Collection::Id colId = collection.id();
             const Akonadi::AgentInstance instance = Akonadi::AgentManager::self()->instance(collection.resource());
             if (!instance.isOnline() && !collection.isVirtual()) {
-                return i18nc("@item this is the default calendar", "%1 (Offline)", collection.displayName());
-            }
-            if (colId == CalendarSupport::KCalPrefs::instance()->defaultCalendarId()) {
-                return i18nc("@item this is the default calendar", "%1 (Default)", collection.displayName());
+                decoration.label = i18nc("@item this is the default calendar", "%1 (Offline)", collection.displayName());
+            } else if (collection.id() == defaultCalendarId) {
+                decoration.label = i18nc("@item this is the default calendar", "%1 (Default)", collection.displayName());
             }
+            it = mDecorations.insert(collection.id(), decoration);
         }
-
-        return QSortFilterProxyModel::data(index, role);
+        return &it.value();
     }
 
-    Qt::ItemFlags flags(const QModelIndex &index) const override
+    void resourceChanged(const QString &identifier)
     {
-        return Qt::ItemIsSelectable | QSortFilterProxyModel::flags(index);
+        QVector<Akonadi::Collection::Id> changed;
+        for (auto it = mDecorations.begin(); it != mDecorations.end();) {
+            if (it->resource == identifier) {
+                changed << it.key();
+                it = mDecorations.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        for (Akonadi::Collection::Id id : std::as_const(changed)) {
+            const QModelIndex index = Akonadi::EntityTreeModel::modelIndexForCollection(this, Akonadi::Collection(id));
+            if (index.isValid()) {
+                Q_EMIT dataChanged(index, index);
+            }
+        }
     }
 
-private:
+    /** decorations, keyed by collection id */
+    mutable QHash<Akonadi::Collection::Id, Decoration> mDecorations;
+    mutable Akonadi::Collection::Id mDefaultCalendarId = -1;
     mutable bool mInitDefaultCalendar;
 };
 
@@ -423,11 +501,9 @@ AkonadiCollectionView::AkonadiCollectionView(CalendarView *view, bool hasContext
     mCollectionView->header()->hide();
     mCollectionView->setRootIsDecorated(true);
     // mCollectionView->setSorting( true );
-    {
-        auto delegate = new StyledCalendarDelegate(mCollectionView);
-        connect(delegate, &StyledCalendarDelegate::action, this, &AkonadiCollectionView::onAction);
-        mCollectionView->setItemDelegate(delegate);
-    }
+    auto collectionDelegate = new StyledCalendarDelegate(mCollectionView);
+    connect(collectionDelegate, &StyledCalendarDelegate::action, this, &AkonadiCollectionView::onAction);
+    mCollectionView->setItemDelegate(collectionDelegate);
     mCollectionView->setModel(collectionFilter);
     connect(mCollectionView->selectionModel(), &QItemSelectionModel::selectionChanged, this, &AkonadiCollectionView::updateMenu);
     mNewNodeExpander = new NewNodeExpander(mCollectionView, false, QStringLiteral("CollectionTreeView"));
@@ -447,11 +523,30 @@ AkonadiCollectionView::AkonadiCollectionView(CalendarView *view, bool hasContext
     auto mSearchView = new Akonadi::EntityTreeView(this);
     mSearchView->header()->hide();
     mSearchView->setRootIsDecorated(true);
-    {
-        auto delegate = new StyledCalendarDelegate(mCollectionView);
-        connect(delegate, &StyledCalendarDelegate::action, this, &AkonadiCollectionView::onAction);
-        mSearchView->setItemDelegate(delegate);
-    }
+    auto searchDelegate = new StyledCalendarDelegate(mCollectionView);
+    connect(searchDelegate, &StyledCalendarDelegate::action, this, &AkonadiCollectionView::onAction);
+    mSearchView->setItemDelegate(searchDelegate);
+
+    // The delegates cache the collection colors
+    connect(colorProxy,
+            &QAbstractItemModel::dataChanged,
+            this,
+            [colorProxy, collectionDelegate, searchDelegate](const QModelIndex &topLeft, const QModelIndex &bottomRight) {
+        for (int row = topLeft.row(); row <= bottomRight.row(); ++row) {
+            const Akonadi::Collection::Id id = CalendarSupport::collectionFromIndex(colorProxy->index(row, 0, topLeft.parent())).id();
+            collectionDelegate->invalidateColor(id);
+            searchDelegate->invalidateColor(id);
+        }
+    });
+    auto clearColors = [this, collectionDelegate, searchDelegate, mSearchView]() {
+        collectionDelegate->clearColors();
+        searchDelegate->clearColors();
+        mCollectionView->viewport()->update();
+        mSearchView->viewport()->update();
+    };
+    connect(this, &AkonadiCollectionView::colorsChanged, this, clearColors);
+    connect(KOPrefs::instance(), &KOPrefs::configChanged, this, clearColors);
+
     mSearchView->setModel(filterTreeViewModel);
     new NewNodeExpander(mSearchView, true, QString());
 
@@ -0,0 +1,191 @@
+/*
+  This file is part of KOrganizer.
+
+  SPDX-FileCopyrightText: 2026 KOrganizer Developers
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+#include "kodaymatrixbenchmark.h"
+
+#include "../kodaymatrix.h"
+
+#include <KCalendarCore/Event>
+#include <KCalendarCore/Todo>
+
+#include <QTimeZone>
+
+#include <QPixmap>
+#include <QTest>
+QTEST_MAIN(KODayMatrixBenchmark)
+
+static const QDate sMatrixStart(2011, 2, 28);
+static const int sMatrixDays = 42;
+
+/**
+ * The scan KODayMatrix ran over the whole calendar after every change before
+ * it kept a per-day index, without the daily and weekly recurrence settings.
+ * Returns the days with events or to-dos.
+ */
+static QList<QDate> scanCalendar(const KCalendarCore::Calendar::Ptr &calendar)
+{
+    const QDate first = sMatrixStart;
+    const QDate last = sMatrixStart.addDays(sMatrixDays - 1);
+    QList<QDate> days;
+
+    const KCalendarCore::Event::List events = calendar->events(first, last, calendar->timeZone());
+    for (const KCalendarCore::Event::Ptr &event : events) {
+        if (days.count() == sMatrixDays) {
+            break;
+        }
+        const QDateTime dtStart = event->dtStart().toLocalTime();
+        const QDateTime dtEnd = event->dtEnd().toLocalTime().addSecs(event->allDay() ? 0 : -1);
+        const bool isRecurrent = event->recurs();
+        const int eventDuration = dtStart.daysTo(dtEnd);
+
+        KCalendarCore::DateTimeList timeDateList;
+        if (isRecurrent) {
+            timeDateList = event->recurrence()->timesInInterval(QDateTime(first, {}, Qt::LocalTime), QDateTime(last, {}, Qt::LocalTime));
+        } else if (dtStart.date() >= first) {
+            timeDateList.append(dtStart);
+        } else {
+            timeDateList.append(QDateTime(first, {}, Qt::LocalTime));
+        }
+
+        for (const QDateTime &dt : std::as_const(timeDateList)) {
+            QDate d = dt.toLocalTime().date();
+            const QDate occurrenceEnd = isRecurrent ? d.addDays(eventDuration) : dtEnd.date();
+            int j = 0;
+            do {
+                days.append(d);
+                ++j;
+                d = d.addDays(1);
+            } while (d <= occurrenceEnd && j < sMatrixDays);
+        }
+    }
+
+    const KCalendarCore::Todo::List todos = calendar->todos();
+    for (const KCalendarCore::Todo::Ptr &todo : todos) {
+        if (days.count() == sMatrixDays) {
+            break;
+        }
+        if (!todo->hasDueDate()) {
+            continue;
+        }
+        if (todo->recurs()) {
+            const auto timeDateList =
+                todo->recurrence()->timesInInterval(QDateTime(first, {}, Qt::LocalTime), QDateTime(last, {}, Qt::LocalTime));
+            for (const QDateTime &dt : timeDateList) {
+                const QDate d = dt.toLocalTime().date();
+                if (!days.contains(d)) {
+                    days.append(d);
+                }
+            }
+        } else {
+            const QDate d = todo->dtDue().toLocalTime().date();
+            if (d >= first && d <= last && !days.contains(d)) {
+                days.append(d);
+            }
+        }
+    }
+    return days;
+}
+
+void KODayMatrixBenchmark::initTestCase()
+{
+    // a mix of single day, multi day and recurring incidences overlapping each other
+    for (int i = 0; i < 500; ++i) {
+        const QDateTime start(sMatrixStart.addDays(i % 45 - 2), QTime(9, 0));
+        if (i % 5 == 0) {
+            KCalendarCore::Todo::Ptr todo(new KCalendarCore::Todo);
+            todo->setSummary(QStringLiteral("Todo %1").arg(i));
+            todo->setDtDue(start);
+            mIncidences.append(todo);
+        } else {
+            KCalendarCore::Event::Ptr event(new KCalendarCore::Event);
+            event->setSummary(QStringLiteral("Event %1").arg(i));
+            event->setDtStart(start);
+            event->setDtEnd(start.addDays(i % 3).addSecs(3600));
+            if (i % 7 == 0) {
+                event->recurrence()->setMonthly(1);
+            }
+            mIncidences.append(event);
+        }
+    }
+
+    mCalendar = KCalendarCore::MemoryCalendar::Ptr(new KCalendarCore::MemoryCalendar(QTimeZone::systemTimeZone()));
+    for (const KCalendarCore::Incidence::Ptr &incidence : std::as_const(mIncidences)) {
+        QVERIFY(mCalendar->addIncidence(incidence));
+    }
+}
+
+void KODayMatrixBenchmark::benchmarkIndexing()
+{
+    KODayMatrix matrix(nullptr);
+    matrix.setHighlightMode(true, true, false);
+    matrix.updateView(sMatrixStart);
+
+    QBENCHMARK {
+        for (const KCalendarCore::Incidence::Ptr &incidence : std::as_const(mIncidences)) {
+            matrix.calendarIncidenceChanged(incidence);
+        }
+    }
+    // the incidences start on every day of the matrix
+    for (int i = 0; i < sMatrixDays; ++i) {
+        QVERIFY(matrix.hasIncidences(i));
+    }
+
+    for (const KCalendarCore::Incidence::Ptr &incidence : std::as_const(mIncidences)) {
+        matrix.calendarIncidenceDeleted(incidence, nullptr);
+    }
+    for (int i = 0; i < sMatrixDays; ++i) {
+        QVERIFY(!matrix.hasIncidences(i));
+    }
+}
+
+// What a single change costs now: the changed incidence is indexed again
+void KODayMatrixBenchmark::benchmarkIncidenceChanged()
+{
+    KODayMatrix matrix(nullptr);
+    matrix.setHighlightMode(true, true, false);
+    matrix.updateView(sMatrixStart);
+    for (const KCalendarCore::Incidence::Ptr &incidence : std::as_const(mIncidences)) {
+        matrix.calendarIncidenceAdded(incidence);
+    }
+
+    int i = 0;
+    QBENCHMARK {
+        matrix.calendarIncidenceChanged(mIncidences.at(i++ % mIncidences.count()));
+    }
+    for (int day = 0; day < sMatrixDays; ++day) {
+        QVERIFY(matrix.hasIncidences(day));
+    }
+}
+
+// What a single change cost before the index: the whole calendar was scanned again
+void KODayMatrixBenchmark::benchmarkFullScan()
+{
+    QList<QDate> days;
+    QBENCHMARK {
+        days = scanCalendar(mCalendar);
+    }
+    for (int day = 0; day < sMatrixDays; ++day) {
+        QVERIFY(days.contains(sMatrixStart.addDays(day)));
+    }
+}
+
+void KODayMatrixBenchmark::benchmarkPainting()
+{
+    KODayMatrix matrix(nullptr);
+    matrix.setHighlightMode(true, true, false);
+    matrix.updateView(sMatrixStart);
+    for (const KCalendarCore::Incidence::Ptr &incidence : std::as_const(mIncidences)) {
+        matrix.calendarIncidenceAdded(incidence);
+    }
+    matrix.setSelectedDaysFrom(sMatrixStart.addDays(10), sMatrixStart.addDays(20));
+    matrix.resize(280, 180);
+
+    QPixmap pixmap(matrix.size());
+    QBENCHMARK {
+        matrix.render(&pixmap);
+    }
+}
@@ -0,0 +1,31 @@
+/*
+  This file is part of KOrganizer.
+
+  SPDX-FileCopyrightText: 2026 KOrganizer Developers
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <KCalendarCore/Incidence>
+#include <KCalendarCore/MemoryCalendar>
+
+#include <QObject>
+
+class KODayMatrixBenchmark : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void benchmarkIndexing();
+    void benchmarkIncidenceChanged();
+    void benchmarkFullScan();
+    void benchmarkPainting();
+
+private:
+    KCalendarCore::Incidence::List mIncidences;
+    /** the same incidences, for the full calendar scan the index replaced */
+    KCalendarCore::MemoryCalendar::Ptr mCalendar;
+};
+
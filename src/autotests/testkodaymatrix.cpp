@@ -9,11 +9,40 @@
 
 #include "../kodaymatrix.h"
 
+#include <KCalendarCore/CalFilter>
+#include <KCalendarCore/Event>
+#include <KCalendarCore/Journal>
+#include <KCalendarCore/Todo>
+
 #include <QTest>
 QTEST_MAIN(KODayMatrixTest)
 
 using DateRange = QPair<QDate, QDate>;
 
+// a Monday, so the matrix starts on it
+static const QDate sMatrixStart(2011, 2, 28);
+
+// An event from 9:00 on the first day to 10:00 on the last day of the matrix
+static KCalendarCore::Event::Ptr createEvent(int firstDay, int lastDay)
+{
+    KCalendarCore::Event::Ptr event(new KCalendarCore::Event);
+    event->setDtStart(QDateTime(sMatrixStart.addDays(firstDay), QTime(9, 0)));
+    event->setDtEnd(QDateTime(sMatrixStart.addDays(lastDay), QTime(10, 0)));
+    return event;
+}
+
+// Returns the offsets of the days drawn in bold
+static QList<int> highlightedDays(const KODayMatrix &matrix)
+{
+    QList<int> days;
+    for (int i = 0; i < 42; ++i) {
+        if (matrix.hasIncidences(i)) {
+            days.append(i);
+        }
+    }
+    return days;
+}
+
 void KODayMatrixTest::testMatrixLimits()
 {
     QMap<QDate, DateRange> dates;
@@ -32,3 +61,131 @@ void KODayMatrixTest::testMatrixLimits()
         QVERIFY(range == iterator.value());
     }
 }
+
+void KODayMatrixTest::testIncidenceAdded()
+{
+    KODayMatrix matrix(nullptr);
+    matrix.setHighlightMode(true, true, false);
+    matrix.updateView(sMatrixStart);
+    QVERIFY(highlightedDays(matrix).isEmpty());
+
+    matrix.calendarIncidenceAdded(createEvent(3, 4));
+    QCOMPARE(highlightedDays(matrix), QList<int>({3, 4}));
+
+    // a timed event ending at midnight doesn't occur on its end day
+    KCalendarCore::Event::Ptr event = createEvent(6, 7);
+    event->setDtEnd(QDateTime(sMatrixStart.addDays(7), QTime(0, 0)));
+    matrix.calendarIncidenceAdded(event);
+    QCOMPARE(highlightedDays(matrix), QList<int>({3, 4, 6}));
+
+    // days outside of the matrix are clipped
+    matrix.calendarIncidenceAdded(createEvent(-3, 1));
+    matrix.calendarIncidenceAdded(createEvent(41, 45));
+    QCOMPARE(highlightedDays(matrix), QList<int>({0, 1, 3, 4, 6, 41}));
+
+    KCalendarCore::Todo::Ptr todo(new KCalendarCore::Todo);
+    todo->setDtDue(QDateTime(sMatrixStart.addDays(20), QTime(12, 0)));
+    matrix.calendarIncidenceAdded(todo);
+
+    // journals are not highlighted
+    KCalendarCore::Journal::Ptr journal(new KCalendarCore::Journal);
+    journal->setDtStart(QDateTime(sMatrixStart.addDays(21), QTime(12, 0)));
+    matrix.calendarIncidenceAdded(journal);
+    QCOMPARE(highlightedDays(matrix), QList<int>({0, 1, 3, 4, 6, 20, 41}));
+
+    // adding an incidence again doesn't count it twice
+    matrix.calendarIncidenceAdded(todo);
+    matrix.calendarIncidenceDeleted(todo, nullptr);
+    QCOMPARE(highlightedDays(matrix), QList<int>({0, 1, 3, 4, 6, 41}));
+}
+
+void KODayMatrixTest::testIncidenceChanged()
+{
+    KODayMatrix matrix(nullptr);
+    matrix.setHighlightMode(true, true, false);
+    matrix.updateView(sMatrixStart);
+
+    KCalendarCore::Event::Ptr event = createEvent(3, 5);
+    matrix.calendarIncidenceAdded(event);
+    matrix.calendarIncidenceAdded(createEvent(5, 5));
+    QCOMPARE(highlightedDays(matrix), QList<int>({3, 4, 5}));
+
+    // moving the event releases the days it no longer covers, but not the
+    // days still covered by other incidences
+    event->setDtStart(QDateTime(sMatrixStart.addDays(10), QTime(9, 0)));
+    event->setDtEnd(QDateTime(sMatrixStart.addDays(11), QTime(10, 0)));
+    matrix.calendarIncidenceChanged(event);
+    QCOMPARE(highlightedDays(matrix), QList<int>({5, 10, 11}));
+
+    // moving it out of the matrix removes it
+    event->setDtStart(QDateTime(sMatrixStart.addDays(60), QTime(9, 0)));
+    event->setDtEnd(QDateTime(sMatrixStart.addDays(60), QTime(10, 0)));
+    matrix.calendarIncidenceChanged(event);
+    QCOMPARE(highlightedDays(matrix), QList<int>({5}));
+
+    // a to-do without due date is not shown, one with a due date is
+    KCalendarCore::Todo::Ptr todo(new KCalendarCore::Todo);
+    matrix.calendarIncidenceAdded(todo);
+    QCOMPARE(highlightedDays(matrix), QList<int>({5}));
+    todo->setDtDue(QDateTime(sMatrixStart.addDays(8), QTime(12, 0)));
+    matrix.calendarIncidenceChanged(todo);
+    QCOMPARE(highlightedDays(matrix), QList<int>({5, 8}));
+}
+
+void KODayMatrixTest::testIncidenceDeleted()
+{
+    KODayMatrix matrix(nullptr);
+    matrix.setHighlightMode(true, true, false);
+    matrix.updateView(sMatrixStart);
+
+    const KCalendarCore::Event::Ptr first = createEvent(3, 4);
+    const KCalendarCore::Event::Ptr second = createEvent(4, 4);
+    matrix.calendarIncidenceAdded(first);
+    matrix.calendarIncidenceAdded(second);
+
+    matrix.calendarIncidenceDeleted(first, nullptr);
+    QCOMPARE(highlightedDays(matrix), QList<int>({4}));
+
+    // deleting an incidence which isn't indexed changes nothing
+    matrix.calendarIncidenceDeleted(first, nullptr);
+    matrix.calendarIncidenceDeleted(createEvent(4, 4), nullptr);
+    QCOMPARE(highlightedDays(matrix), QList<int>({4}));
+
+    matrix.calendarIncidenceDeleted(second, nullptr);
+    QVERIFY(highlightedDays(matrix).isEmpty());
+}
+
+void KODayMatrixTest::testFilter()
+{
+    Akonadi::ETMCalendar::Ptr calendar(new Akonadi::ETMCalendar());
+    KODayMatrix matrix(nullptr);
+    matrix.setHighlightMode(true, true, false);
+    matrix.setCalendar(calendar);
+    matrix.updateView(sMatrixStart);
+
+    matrix.calendarIncidenceAdded(createEvent(3, 3));
+    QCOMPARE(highlightedDays(matrix), QList<int>({3}));
+
+    KCalendarCore::CalFilter filter;
+    filter.setCriteria(KCalendarCore::CalFilter::ShowCategories);
+    filter.setCategoryList({QStringLiteral("Work")});
+    calendar->setFilter(&filter);
+
+    // the calendar doesn't notify its observers of the new filter, the next
+    // update has to rebuild the index from the (empty) calendar anyway
+    matrix.updateView();
+    QVERIFY(highlightedDays(matrix).isEmpty());
+
+    const KCalendarCore::Event::Ptr work = createEvent(5, 5);
+    work->setCategories(QStringLiteral("Work"));
+    matrix.calendarIncidenceAdded(work);
+    matrix.calendarIncidenceAdded(createEvent(6, 6));
+    QCOMPARE(highlightedDays(matrix), QList<int>({5}));
+
+    // an incidence no longer passing the filter is removed
+    work->setCategories(QStringList());
+    matrix.calendarIncidenceChanged(work);
+    QVERIFY(highlightedDays(matrix).isEmpty());
+
+    calendar->setFilter(nullptr);
+}
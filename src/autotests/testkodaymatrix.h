@@ -15,5 +15,9 @@ class KODayMatrixTest : public QObject
     Q_OBJECT
 private Q_SLOTS:
     void testMatrixLimits();
+    void testIncidenceAdded();
+    void testIncidenceChanged();
+    void testIncidenceDeleted();
+    void testFilter();
 };
 
@@ -0,0 +1,109 @@
+/*
+  This file is part of KOrganizer.
+
+  SPDX-FileCopyrightText: 2026 KOrganizer Developers
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+#include "testoccurrencecache.h"
+
+#include "../occurrencecache.h"
+
+#include <KCalendarCore/Event>
+
+#include <QTest>
+QTEST_MAIN(OccurrenceCacheTest)
+
+static const QDate sRangeStart(2011, 2, 28);
+static const QDate sRangeEnd(2011, 4, 10);
+
+// A daily event at 9:00, starting on March 1st 2011
+static KCalendarCore::Event::Ptr createDailyEvent(int count)
+{
+    KCalendarCore::Event::Ptr event(new KCalendarCore::Event);
+    event->setDtStart(QDateTime(QDate(2011, 3, 1), QTime(9, 0)));
+    event->setDtEnd(QDateTime(QDate(2011, 3, 1), QTime(10, 0)));
+    event->recurrence()->setDaily(1);
+    event->recurrence()->setDuration(count);
+    return event;
+}
+
+void OccurrenceCacheTest::testTimesInInterval_data()
+{
+    QTest::addColumn<QDateTime>("start");
+    QTest::addColumn<QDateTime>("end");
+
+    QTest::newRow("whole range") << QDateTime(sRangeStart, {}) << QDateTime(sRangeEnd, {});
+    QTest::newRow("inner days") << QDateTime(QDate(2011, 3, 5), {}) << QDateTime(QDate(2011, 3, 7), QTime(23, 59));
+    QTest::newRow("bounds on occurrences") << QDateTime(QDate(2011, 3, 5), QTime(9, 0)) << QDateTime(QDate(2011, 3, 7), QTime(9, 0));
+    QTest::newRow("bounds next to occurrences") << QDateTime(QDate(2011, 3, 5), QTime(9, 0, 1)) << QDateTime(QDate(2011, 3, 7), QTime(8, 59, 59));
+    QTest::newRow("single occurrence") << QDateTime(QDate(2011, 3, 10), QTime(9, 0)) << QDateTime(QDate(2011, 3, 10), QTime(9, 0));
+    QTest::newRow("between occurrences") << QDateTime(QDate(2011, 3, 10), QTime(10, 0)) << QDateTime(QDate(2011, 3, 11), QTime(8, 0));
+    QTest::newRow("before the first occurrence") << QDateTime(sRangeStart, {}) << QDateTime(QDate(2011, 3, 1), QTime(8, 0));
+    QTest::newRow("after the last occurrence") << QDateTime(QDate(2011, 3, 30), {}) << QDateTime(sRangeEnd, {});
+}
+
+void OccurrenceCacheTest::testTimesInInterval()
+{
+    QFETCH(QDateTime, start);
+    QFETCH(QDateTime, end);
+
+    const KCalendarCore::Event::Ptr event = createDailyEvent(20);
+    OccurrenceCache cache;
+    cache.setExpansionRange(sRangeStart, sRangeEnd);
+
+    // the first lookup expands the whole range, the second one is served from the cache
+    const KCalendarCore::DateTimeList expected = event->recurrence()->timesInInterval(start, end);
+    QCOMPARE(cache.timesInInterval(event, QDateTime(sRangeStart, {}), QDateTime(sRangeEnd, {})).count(), 20);
+    QCOMPARE(cache.timesInInterval(event, start, end), expected);
+}
+
+void OccurrenceCacheTest::testOutsideExpansionRange()
+{
+    const KCalendarCore::Event::Ptr event = createDailyEvent(60);
+    OccurrenceCache cache;
+    cache.setExpansionRange(sRangeStart, sRangeEnd);
+
+    const QDateTime start(QDate(2011, 4, 5), {});
+    const QDateTime end(QDate(2011, 4, 20), {});
+    QCOMPARE(cache.timesInInterval(event, start, end), event->recurrence()->timesInInterval(start, end));
+
+    // the expansion has grown to cover both the range and the interval
+    const QDateTime rangeStart(sRangeStart, {});
+    QCOMPARE(cache.timesInInterval(event, rangeStart, end), event->recurrence()->timesInInterval(rangeStart, end));
+}
+
+void OccurrenceCacheTest::testInvalidation()
+{
+    const KCalendarCore::Event::Ptr event = createDailyEvent(20);
+    OccurrenceCache cache;
+    cache.setExpansionRange(sRangeStart, sRangeEnd);
+    const QDateTime start(sRangeStart, {});
+    const QDateTime end(sRangeEnd, {});
+    QCOMPARE(cache.timesInInterval(event, start, end).count(), 20);
+
+    // until the observer is told, the cached expansion is used
+    event->recurrence()->setDuration(5);
+    QCOMPARE(cache.timesInInterval(event, start, end).count(), 20);
+    cache.calendarIncidenceChanged(event);
+    QCOMPARE(cache.timesInInterval(event, start, end).count(), 5);
+
+    event->recurrence()->setDuration(7);
+    cache.calendarIncidenceDeleted(event, nullptr);
+    QCOMPARE(cache.timesInInterval(event, start, end).count(), 7);
+
+    event->recurrence()->setDuration(9);
+    cache.calendarIncidenceAdded(event);
+    QCOMPARE(cache.timesInInterval(event, start, end).count(), 9);
+
+    event->recurrence()->setDuration(11);
+    cache.clear();
+    QCOMPARE(cache.timesInInterval(event, start, end).count(), 11);
+
+    // other incidences are not affected
+    const KCalendarCore::Event::Ptr other = createDailyEvent(3);
+    QCOMPARE(cache.timesInInterval(other, start, end).count(), 3);
+    other->recurrence()->setDuration(4);
+    cache.calendarIncidenceChanged(event);
+    QCOMPARE(cache.timesInInterval(other, start, end).count(), 3);
+}
@@ -0,0 +1,21 @@
+/*
+  This file is part of KOrganizer.
+
+  SPDX-FileCopyrightText: 2026 KOrganizer Developers
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QObject>
+
+class OccurrenceCacheTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testTimesInInterval_data();
+    void testTimesInInterval();
+    void testOutsideExpansionRange();
+    void testInvalidation();
+};
@@ -0,0 +1,270 @@
+/*
+  This file is part of KOrganizer.
+
+  SPDX-FileCopyrightText: 2026 KOrganizer Developers
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+#include "testsearchindex.h"
+
+#include "../dialog/searchindex.h"
+
+#include <KCalendarCore/Event>
+
+#include <QRegExp>
+#include <QTest>
+QTEST_MAIN(SearchIndexTest)
+
+static const SearchIndex::Fields sAllFields =
+    SearchIndex::Summary | SearchIndex::Description | SearchIndex::Categories | SearchIndex::Location | SearchIndex::Attendees;
+
+static KCalendarCore::Event::Ptr createEvent(const QString &summary,
+                                             const QString &description = QString(),
+                                             const QString &location = QString(),
+                                             const QString &categories = QString(),
+                                             const QString &attendee = QString())
+{
+    KCalendarCore::Event::Ptr event(new KCalendarCore::Event);
+    event->setDtStart(QDateTime(QDate(2026, 3, 2), QTime(9, 0)));
+    event->setSummary(summary);
+    event->setDescription(description);
+    event->setLocation(location);
+    event->setCategories(categories);
+    if (!attendee.isEmpty()) {
+        event->addAttendee(KCalendarCore::Attendee(attendee, attendee.section(QLatin1Char(' '), 0, 0).toLower() + QStringLiteral("@example.org")));
+    }
+    return event;
+}
+
+// The reference matching, as done by the search dialog
+static bool matches(const QRegExp &re, const KCalendarCore::Incidence::Ptr &incidence, SearchIndex::Fields fields)
+{
+    if ((fields & SearchIndex::Summary) && re.indexIn(incidence->summary()) != -1) {
+        return true;
+    }
+    if ((fields & SearchIndex::Description) && re.indexIn(incidence->description()) != -1) {
+        return true;
+    }
+    if ((fields & SearchIndex::Categories) && re.indexIn(incidence->categoriesStr()) != -1) {
+        return true;
+    }
+    if ((fields & SearchIndex::Location) && re.indexIn(incidence->location()) != -1) {
+        return true;
+    }
+    if (fields & SearchIndex::Attendees) {
+        const KCalendarCore::Attendee::List attendees = incidence->attendees();
+        for (const KCalendarCore::Attendee &attendee : attendees) {
+            if (re.indexIn(attendee.fullName()) != -1) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+static QRegExp wildcard(const QString &pattern)
+{
+    return QRegExp(pattern, Qt::CaseInsensitive, QRegExp::Wildcard);
+}
+
+// An index which has been built from the (empty) calendar and then got the incidences added
+static void addIncidences(SearchIndex &index, const KCalendarCore::Incidence::List &incidences)
+{
+    QSet<QString> candidates;
+    const bool built = index.candidates(QStringLiteral("build"), sAllFields, candidates);
+    Q_UNUSED(built)
+    for (const KCalendarCore::Incidence::Ptr &incidence : incidences) {
+        index.calendarIncidenceAdded(incidence);
+    }
+}
+
+void SearchIndexTest::initTestCase()
+{
+    mIncidences = {
+        createEvent(QStringLiteral("Team meeting"),
+                    QStringLiteral("Discuss the e-mail backlog"),
+                    QStringLiteral("Room 42"),
+                    QStringLiteral("Work"),
+                    QStringLiteral("Jürgen Müller")),
+        createEvent(QStringLiteral("Dentist"), QStringLiteral("Bring the X-ray"), QStringLiteral("Dr. Smith's office"), QStringLiteral("Health,Private")),
+        createEvent(QStringLiteral("meetings review"), QString(), QStringLiteral("Café Über")),
+        createEvent(QStringLiteral("Homemeeting"), QStringLiteral("grocery list: milk, eggs")),
+        createEvent(QStringLiteral("Release 5.2.1 party"), QStringLiteral("v5.2.1 tagged"), QString(), QStringLiteral("Work")),
+        createEvent(QStringLiteral("ÜBERSICHT"), QString(), QString(), QString(), QStringLiteral("Anna Smith")),
+        createEvent(QStringLiteral("Team-Meeting (weekly)"), QStringLiteral("[draft] agenda")),
+    };
+}
+
+void SearchIndexTest::testCandidates_data()
+{
+    QTest::addColumn<QString>("pattern");
+
+    const QStringList patterns = {
+        // whole words, prefixes, suffixes and the middle of words, in any case
+        QStringLiteral("meeting"),
+        QStringLiteral("MEETING"),
+        QStringLiteral("meet"),
+        QStringLiteral("eting"),
+        QStringLiteral("eeti"),
+        QStringLiteral("home"),
+        // several words
+        QStringLiteral("team meeting"),
+        QStringLiteral("team-meeting"),
+        QStringLiteral("room 42"),
+        QStringLiteral("milk, eggs"),
+        QStringLiteral("(weekly)"),
+        // wildcards
+        QStringLiteral("team*meeting"),
+        QStringLiteral("team?meeting"),
+        QStringLiteral("*meeting*"),
+        QStringLiteral("mee?ing"),
+        QStringLiteral("m??ting"),
+        QStringLiteral("*meet*ing"),
+        QStringLiteral("t*g"),
+        QStringLiteral("caf?"),
+        QStringLiteral("?ber"),
+        // sets of characters
+        QStringLiteral("[Tt]eam"),
+        QStringLiteral("[a-z]entist"),
+        QStringLiteral("d[eu]ntist"),
+        QStringLiteral("[xyz]-ray"),
+        QStringLiteral("team[ -]meeting"),
+        // separators
+        QStringLiteral("e-mail"),
+        QStringLiteral("x-ray"),
+        QStringLiteral("5.2.1"),
+        QStringLiteral("5.2"),
+        QStringLiteral(".2."),
+        QStringLiteral("smith's"),
+        QStringLiteral("dr. smith"),
+        QStringLiteral("health,private"),
+        QStringLiteral("@example.org>"),
+        QStringLiteral("müller <jürgen"),
+        QStringLiteral(","),
+        // letters beyond ASCII
+        QStringLiteral("über"),
+        QStringLiteral("ÜBER"),
+        QStringLiteral("übersicht"),
+        QStringLiteral("café"),
+        QStringLiteral("jürgen"),
+        // patterns without words
+        QString(),
+        QStringLiteral("*"),
+        QStringLiteral("?"),
+        QStringLiteral("[xyz]"),
+        // no match
+        QStringLiteral("nothing matches this"),
+    };
+    for (const QString &pattern : patterns) {
+        QTest::newRow(pattern.isEmpty() ? "empty" : pattern.toUtf8().constData()) << pattern;
+    }
+}
+
+void SearchIndexTest::testCandidates()
+{
+    QFETCH(QString, pattern);
+
+    Akonadi::ETMCalendar::Ptr calendar(new Akonadi::ETMCalendar());
+    SearchIndex index(calendar);
+    addIncidences(index, mIncidences);
+
+    const QRegExp re = wildcard(pattern);
+    QVERIFY(re.isValid());
+
+    const QVector<SearchIndex::Fields> fieldSets = {sAllFields,
+                                                    SearchIndex::Summary,
+                                                    SearchIndex::Description,
+                                                    SearchIndex::Categories,
+                                                    SearchIndex::Location,
+                                                    SearchIndex::Attendees};
+    for (const SearchIndex::Fields fields : fieldSets) {
+        QSet<QString> candidates;
+        if (!index.candidates(pattern, fields, candidates)) {
+            // every incidence is a candidate
+            continue;
+        }
+        for (const KCalendarCore::Incidence::Ptr &incidence : std::as_const(mIncidences)) {
+            if (matches(re, incidence, fields)) {
+                QVERIFY2(candidates.contains(incidence->instanceIdentifier()),
+                         qPrintable(QStringLiteral("\"%1\" misses \"%2\" in fields %3").arg(pattern, incidence->summary()).arg(int(fields))));
+            }
+        }
+    }
+}
+
+void SearchIndexTest::testSelectivity()
+{
+    Akonadi::ETMCalendar::Ptr calendar(new Akonadi::ETMCalendar());
+    SearchIndex index(calendar);
+    addIncidences(index, mIncidences);
+
+    QSet<QString> candidates;
+    QVERIFY(index.candidates(QStringLiteral("dentist"), sAllFields, candidates));
+    QCOMPARE(candidates, QSet<QString>({mIncidences.at(1)->instanceIdentifier()}));
+
+    // the word is only in the summary
+    QVERIFY(index.candidates(QStringLiteral("dentist"), SearchIndex::Description | SearchIndex::Location, candidates));
+    QVERIFY(candidates.isEmpty());
+
+    QVERIFY(index.candidates(QStringLiteral("work"), SearchIndex::Categories, candidates));
+    QCOMPARE(candidates, QSet<QString>({mIncidences.at(0)->instanceIdentifier(), mIncidences.at(4)->instanceIdentifier()}));
+
+    QVERIFY(index.candidates(QStringLiteral("nothing matches this"), sAllFields, candidates));
+    QVERIFY(candidates.isEmpty());
+
+    QVERIFY(!index.candidates(QStringLiteral("*?"), sAllFields, candidates));
+}
+
+void SearchIndexTest::testWords()
+{
+    QCOMPARE(SearchIndex::words(QStringLiteral("Team-Meeting (weekly), v5.2")),
+             QStringList({QStringLiteral("team"), QStringLiteral("meeting"), QStringLiteral("weekly"), QStringLiteral("v5"), QStringLiteral("2")}));
+    QCOMPARE(SearchIndex::words(QStringLiteral("ÜBER über")), QStringList({QStringLiteral("über"), QStringLiteral("über")}));
+    QVERIFY(SearchIndex::words(QStringLiteral(" ,.- ")).isEmpty());
+}
+
+void SearchIndexTest::testUpdates()
+{
+    Akonadi::ETMCalendar::Ptr calendar(new Akonadi::ETMCalendar());
+    SearchIndex index(calendar);
+    addIncidences(index, mIncidences);
+
+    const KCalendarCore::Incidence::Ptr incidence(mIncidences.at(1)->clone());
+    const QString id = incidence->instanceIdentifier();
+    QSet<QString> candidates;
+
+    // a changed incidence is found by its new words only
+    incidence->setSummary(QStringLiteral("Orthodontist"));
+    index.calendarIncidenceChanged(incidence);
+    QVERIFY(index.candidates(QStringLiteral("dentist"), SearchIndex::Summary, candidates));
+    QVERIFY(candidates.contains(id));
+    QVERIFY(index.candidates(QStringLiteral("dentist*"), SearchIndex::Summary, candidates));
+    QVERIFY(candidates.contains(id));
+    QVERIFY(index.candidates(QStringLiteral(" dentist"), SearchIndex::Summary, candidates));
+    QVERIFY(candidates.isEmpty());
+    QVERIFY(index.candidates(QStringLiteral("orthodontist"), SearchIndex::Summary, candidates));
+    QCOMPARE(candidates, QSet<QString>({id}));
+    QVERIFY(index.candidates(QStringLiteral("x-ray"), SearchIndex::Description, candidates));
+    QCOMPARE(candidates, QSet<QString>({id}));
+
+    // words only the incidence had are dropped from the dictionary
+    incidence->setDescription(QString());
+    index.calendarIncidenceChanged(incidence);
+    QVERIFY(index.candidates(QStringLiteral("x-ray"), sAllFields, candidates));
+    QVERIFY(candidates.isEmpty());
+
+    index.calendarIncidenceDeleted(incidence, nullptr);
+    QVERIFY(index.candidates(QStringLiteral("orthodontist"), sAllFields, candidates));
+    QVERIFY(candidates.isEmpty());
+    QVERIFY(index.candidates(QStringLiteral("smith"), SearchIndex::Location, candidates));
+    QVERIFY(candidates.isEmpty());
+
+    // words shared with other incidences are kept
+    QVERIFY(index.candidates(QStringLiteral("smith"), sAllFields, candidates));
+    QCOMPARE(candidates, QSet<QString>({mIncidences.at(5)->instanceIdentifier()}));
+
+    const KCalendarCore::Event::Ptr added = createEvent(QStringLiteral("Dentist again"));
+    index.calendarIncidenceAdded(added);
+    QVERIFY(index.candidates(QStringLiteral("dentist"), sAllFields, candidates));
+    QCOMPARE(candidates, QSet<QString>({added->instanceIdentifier()}));
+}
@@ -0,0 +1,28 @@
+/*
+  This file is part of KOrganizer.
+
+  SPDX-FileCopyrightText: 2026 KOrganizer Developers
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <Akonadi/Calendar/ETMCalendar>
+
+#include <QObject>
+
+class SearchIndexTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void testCandidates_data();
+    void testCandidates();
+    void testSelectivity();
+    void testWords();
+    void testUpdates();
+
+private:
+    KCalendarCore::Incidence::List mIncidences;
+};
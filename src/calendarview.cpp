@@ -79,6 +79,7 @@
 #include <QFileDialog>
 #include <QSplitter>
 #include <QStackedWidget>
+#include <QTimer>
 #include <QVBoxLayout>
 
 // Meaningful aliases for dialog box return codes.
@@ -90,11 +91,19 @@ enum ItemActions {
     All = KMessageBox::Continue,  // Instance and child instances.
 };
 
+// What a refresh request without a known cause may have changed
+static const EventViews::EventView::Changes s_unknownChanges = EventViews::EventView::Changes(EventViews::EventView::IncidencesAdded)
+    | EventViews::EventView::IncidencesEdited | EventViews::EventView::IncidencesDeleted | EventViews::EventView::ConfigChanged;
 
 CalendarView::CalendarView(QWidget *parent)
     : CalendarViewBase(parent)
     , mSearchCollectionHelper(this)
+    , mUpdateTimer(new QTimer(this))
 {
+    mUpdateTimer->setSingleShot(true);
+    mUpdateTimer->setInterval(0);
+    connect(mUpdateTimer, &QTimer::timeout, this, &CalendarView::processPendingUpdate);
+
     Akonadi::ControlGui::widgetNeedsAkonadi(this);
     mChanger = new Akonadi::IncidenceChanger(new IncidenceEditorNG::IndividualMailComponentFactory(this), this);
     mChanger->setDefaultCollection(Akonadi::Collection(CalendarSupport::KCalPrefs::instance()->defaultCalendarId()));
@@ -225,7 +234,6 @@ CalendarView::CalendarView(QWidget *parent)
     connect(mDateNavigatorContainer, &DateNavigatorContainer::incidenceDropped, this, &CalendarView::addIncidenceOn);
     connect(mDateNavigatorContainer, &DateNavigatorContainer::incidenceDroppedMove, this, &CalendarView::moveIncidenceTo);
 
-    connect(mDateChecker, &DateChecker::dayPassed, mTodoList, &BaseView::dayPassed);
     connect(mDateChecker, &DateChecker::dayPassed, this, &CalendarView::dayPassed);
     connect(mDateChecker, &DateChecker::dayPassed, mDateNavigatorContainer, &DateNavigatorContainer::updateToday);
 
@@ -687,6 +695,47 @@ void CalendarView::changeIncidenceDisplay(const Akonadi::Item &item, Akonadi::In
 
 void CalendarView::updateView(const QDate &start, const QDate &end, const QDate &preferredMonth, const bool updateTodos)
 {
+    // The latest range wins; the refresh happens once the current event has been handled.
+    mPendingStart = start;
+    mPendingEnd = end;
+    mPendingMonth = preferredMonth;
+    if (updateTodos) {
+        // Callers asking for the to-dos don't tell what changed, so the view is refreshed as well.
+        mPendingTodos = true;
+        mPendingChanges |= s_unknownChanges;
+    }
+    mUpdateTimer->start();
+}
+
+void CalendarView::updateView(EventViews::EventView::Changes changes)
+{
+    const KCalendarCore::DateList tmpList = mDateNavigator->selectedDates();
+    mPendingStart = tmpList.first();
+    mPendingEnd = tmpList.last();
+    mPendingMonth = mDateNavigatorContainer->monthOfNavigator();
+    mPendingTodos = true;
+    mPendingChanges |= changes;
+    mUpdateTimer->start();
+}
+
+void CalendarView::flushPendingUpdate()
+{
+    if (mUpdateTimer->isActive()) {
+        mUpdateTimer->stop();
+        processPendingUpdate();
+    }
+}
+
+void CalendarView::processPendingUpdate()
+{
+    const QDate start = mPendingStart;
+    const QDate end = mPendingEnd;
+    const QDate preferredMonth = mPendingMonth;
+    const bool updateTodos = mPendingTodos;
+    EventViews::EventView::Changes changes = mPendingChanges;
+    mPendingTodos = false;
+    mPendingChanges = EventViews::EventView::NothingChanged;
+
     const bool currentViewIsTodoView = mViewManager->currentView()->identifier() == "DefaultTodoView";
 
     if (updateTodos && !currentViewIsTodoView && mTodoList->isVisible()) {
@@ -695,7 +744,16 @@ void CalendarView::updateView(const QDate &start, const QDate &end, const QDate
     }
 
     if (start.isValid() && end.isValid() && !(currentViewIsTodoView && !updateTodos)) {
-        mViewManager->updateView(start, end, preferredMonth);
+        if (start != mShownStart || end != mShownEnd || preferredMonth != mShownMonth) {
+            changes |= EventViews::EventView::DatesChanged;
+        }
+        // Selecting the dates already shown needs no work
+        if (changes != EventViews::EventView::NothingChanged) {
+            mViewManager->updateView(start, end, preferredMonth);
+            mShownStart = start;
+            mShownEnd = end;
+            mShownMonth = preferredMonth;
+        }
     }
 
     if (mDateNavigatorContainer->isVisible()) {
@@ -1206,7 +1264,7 @@ void CalendarView::todo_unsub()
 {
     const Akonadi::Item aTodo = selectedTodo();
     if (incidence_unsub(aTodo)) {
-        updateView();
+        updateView(EventViews::EventView::IncidencesEdited);
     }
 }
 
@@ -1240,7 +1298,7 @@ bool CalendarView::makeSubTodosIndependent()
     bool status = makeChildrenIndependent(aTodo);
     endMultiModify();
     if (status) {
-        updateView();
+        updateView(EventViews::EventView::IncidencesEdited);
     }
     return status;
 }
@@ -1836,6 +1894,8 @@ void CalendarView::updateFilter()
     Q_EMIT filtersUpdated(filters, pos + 1);
 
     mCalendar->setFilter(mCurrentFilter);
+    // the filter may have been edited in place, which the calendar observers don't hear about
+    mDateNavigatorContainer->setUpdateNeeded();
 }
 
 void CalendarView::filterActivated(int filterNo)
@@ -1847,8 +1907,8 @@ void CalendarView::filterActivated(int filterNo)
     if (newFilter != mCurrentFilter) {
         mCurrentFilter = newFilter;
         mCalendar->setFilter(mCurrentFilter);
-        mViewManager->addChange(EventViews::EventView::FilterChanged);
-        updateView();
+        addChange(EventViews::EventView::FilterChanged);
+        updateView(EventViews::EventView::FilterChanged);
     }
     Q_EMIT filterChanged();
 }
@@ -1882,7 +1942,7 @@ void CalendarView::takeOverEvent()
 
     // PENDING(AKONADI_PORT) call mChanger?
 
-    updateView();
+    updateView(EventViews::EventView::IncidencesEdited);
 }
 
 void CalendarView::showIntro()
@@ -2084,9 +2144,14 @@ void CalendarView::showIncidenceContext(const Akonadi::Item &item)
             viewManager()->showTodoView();
         }
     }
+    // a queued update would replace the incidence with the selected dates
+    flushPendingUpdate();
     Akonadi::Item::List list;
     list.append(item);
     viewManager()->currentView()->showIncidences(list, QDate());
+    // the view no longer shows the selected dates, so selecting them again has to redraw it
+    mShownStart = QDate();
+    mShownEnd = QDate();
 }
 
 bool CalendarView::editIncidence(const Akonadi::Item &item, bool isCounter)
@@ -2419,8 +2484,14 @@ void CalendarView::moveIncidenceTo(const Akonadi::Item &itemmove, QDate dt)
 
 void CalendarView::resourcesChanged()
 {
-    mViewManager->addChange(EventViews::EventView::ResourcesChanged);
-    updateView();
+    addChange(EventViews::EventView::ResourcesChanged);
+    updateView(EventViews::EventView::ResourcesChanged);
+}
+
+void CalendarView::addChange(EventViews::EventView::Change change)
+{
+    mViewManager->addChange(change);
+    mPendingChanges |= change;
 }
 
 bool CalendarView::eventFilter(QObject *watched, QEvent *event)
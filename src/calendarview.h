@@ -53,6 +53,7 @@ class TodoPurger;
 
 class QSplitter;
 class QStackedWidget;
+class QTimer;
 
 using namespace KOrg;
 
@@ -433,6 +434,8 @@ public Q_SLOTS:
 
     void updateView(const QDate &start, const QDate &end, const QDate &preferredMonth, const bool updateTodos = true);
     void updateView() override;
+    /** Updates the views for the selected dates, which have to catch up with @p changes only. */
+    void updateView(EventViews::EventView::Changes changes);
 
     void updateUnmanagedViews();
 
@@ -642,7 +645,15 @@ private Q_SLOTS:
     void onCheckableProxyToggled(bool newState);
     void onTodosPurged(bool success, int numDeleted, int numIgnored);
 
+    /** Carries out the update requests merged since the last refresh. */
+    void processPendingUpdate();
+
 private:
+    /** Marks all views changed and records the change for the next refresh. */
+    void addChange(EventViews::EventView::Change change);
+    /** Carries out a pending update right away, so that what is shown next isn't overwritten by it. */
+    void flushPendingUpdate();
+
     Akonadi::Collection selectedCollection() const;
     Akonadi::Collection::List checkedCollections() const;
 
@@ -713,5 +724,17 @@ private:
     AkonadiCollectionView *mETMCollectionView = nullptr;
 
     SearchCollectionHelper mSearchCollectionHelper;
+
+    // Update requests are merged and carried out once per event loop turn
+    QTimer *const mUpdateTimer;
+    QDate mPendingStart;
+    QDate mPendingEnd;
+    QDate mPendingMonth;
+    bool mPendingTodos = false;
+    EventViews::EventView::Changes mPendingChanges = EventViews::EventView::NothingChanged;
+    // the range last shown by the current view
+    QDate mShownStart;
+    QDate mShownEnd;
+    QDate mShownMonth;
 };
 
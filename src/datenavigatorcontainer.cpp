@@ -13,6 +13,7 @@
 #include "datenavigatorcontainer.h"
 #include "kodaymatrix.h"
 #include "koglobals.h"
+#include "occurrencecache.h"
 #include "widgets/kdatenavigator.h"
 #include "widgets/navigatorbar.h"
 
@@ -23,6 +24,7 @@
 DateNavigatorContainer::DateNavigatorContainer(QWidget *parent)
     : QFrame(parent)
     , mNavigatorView(new KDateNavigator(this))
+    , mOccurrenceCache(new OccurrenceCache)
 {
     mNavigatorView->setWhatsThis(
         i18n("<qt><p>Select the dates you want to "
@@ -35,6 +37,7 @@ DateNavigatorContainer::DateNavigatorContainer(QWidget *parent)
              "Press it to select the whole week.</p>"
              "</qt>"));
 
+    mNavigatorView->setOccurrenceCache(mOccurrenceCache.get());
     connectNavigatorView(mNavigatorView);
 }
 
@@ -72,6 +75,8 @@ void DateNavigatorContainer::connectNavigatorView(KDateNavigator *v)
 void DateNavigatorContainer::setCalendar(const Akonadi::ETMCalendar::Ptr &calendar)
 {
     mCalendar = calendar;
+    // register the cache first, so that it is invalidated before the matrices are notified
+    mOccurrenceCache->setCalendar(calendar);
     mNavigatorView->setCalendar(calendar);
     for (KDateNavigator *n : std::as_const(mExtraViews)) {
         if (n) {
@@ -118,7 +123,7 @@ void DateNavigatorContainer::updateView()
     mNavigatorView->updateView();
     for (KDateNavigator *n : std::as_const(mExtraViews)) {
         if (n) {
-            n->setUpdateNeeded();
+            n->updateDayMatrix();
         }
     }
 }
@@ -176,6 +181,11 @@ void DateNavigatorContainer::selectDates(const KCalendarCore::DateList &dateList
 
 void DateNavigatorContainer::setBaseDates(const QDate &start)
 {
+    // expand recurrences once over the span of all navigators
+    const QDate firstDay = KODayMatrix::matrixLimits(start).first;
+    const QDate lastDay = KODayMatrix::matrixLimits(start.addMonths(mExtraViews.count())).second;
+    mOccurrenceCache->setExpansionRange(firstDay, lastDay);
+
     QDate baseDate = start;
     if (!mIgnoreNavigatorUpdates) {
         mNavigatorView->setBaseDate(baseDate);
@@ -219,6 +229,7 @@ void DateNavigatorContainer::resizeAllContents()
         while (count > (mExtraViews.count() + 1)) {
             auto n = new KDateNavigator(this);
             mExtraViews.append(n);
+            n->setOccurrenceCache(mOccurrenceCache.get());
             n->setCalendar(mCalendar);
             connectNavigatorView(n);
         }
@@ -16,7 +16,11 @@
 
 #include <QDate>
 #include <QFrame>
+
+#include <memory>
+
 class KDateNavigator;
+class OccurrenceCache;
 
 class DateNavigatorContainer : public QFrame
 {
@@ -133,6 +137,9 @@ private:
 
     KDateNavigator *const mNavigatorView;
 
+    /** recurrence expansions shared by the day matrices of all navigators */
+    std::unique_ptr<OccurrenceCache> const mOccurrenceCache;
+
     Akonadi::ETMCalendar::Ptr mCalendar;
 
     QList<KDateNavigator *> mExtraViews;
@@ -12,6 +12,7 @@
 
 #include "calendarview.h"
 #include "koeventpopupmenu.h"
+#include "searchindex.h"
 #include "ui_searchdialog_base.h"
 
 #include <EventViews/ListView>
@@ -23,12 +24,23 @@
 
 #include <QDialogButtonBox>
 #include <QPushButton>
+#include <QTimer>
+
+// Time spent checking incidences before returning to the event loop, in milliseconds
+static const int s_searchSliceTime = 20;
+// Minimum interval between showing the matches found so far, in milliseconds
+static const int s_searchUpdateInterval = 250;
 
 SearchDialog::SearchDialog(CalendarView *calendarview)
     : QDialog(calendarview)
     , m_ui(new Ui::SearchDialog)
     , m_calendarview(calendarview)
+    , m_searchIndex(new SearchIndex(calendarview->calendar()))
+    , m_searchTimer(new QTimer(this))
 {
+    m_searchTimer->setInterval(0);
+    connect(m_searchTimer, &QTimer::timeout, this, &SearchDialog::searchSlice);
+
     setWindowTitle(i18nc("@title:window", "Find in Calendars"));
     setModal(false);
 
@@ -119,16 +131,7 @@ void SearchDialog::doSearch()
         return;
     }
 
-    search(re);
-    m_listView->showIncidences(m_matchedEvents, QDate());
-    updateMatchesText();
-    if (m_matchedEvents.isEmpty()) {
-        m_ui->numItems->setText(QString());
-        KMessageBox::information(this,
-                                 i18nc("@info", "No items were found that match your search pattern."),
-                                 i18nc("@title:window", "Search Results"),
-                                 QStringLiteral("NoSearchResults"));
-    }
+    search(re, true);
 }
 
 void SearchDialog::popupMenu(const QPoint &point)
@@ -151,18 +154,59 @@ void SearchDialog::updateView()
     re.setPatternSyntax(QRegExp::Wildcard); // most people understand these better.
     re.setCaseSensitivity(Qt::CaseInsensitive);
     re.setPattern(m_ui->searchEdit->text());
-    m_listView->clear();
     if (re.isValid()) {
-        search(re);
+        search(re, false);
     } else {
+        cancelSearch();
         m_matchedEvents.clear();
+        m_listView->clear();
+        updateMatchesText();
     }
-    m_listView->showIncidences(m_matchedEvents, QDate());
-    updateMatchesText();
 }
 
-void SearchDialog::search(const QRegExp &re)
+void SearchDialog::cancelSearch()
 {
+    m_searchTimer->stop();
+    m_pendingIncidences.clear();
+    m_pendingIndex = 0;
+}
+
+void SearchDialog::search(const QRegExp &re, bool reportNoMatches)
+{
+    // A newer search replaces the one in progress
+    cancelSearch();
+    m_matchedEvents.clear();
+    m_listView->clear();
+    m_shownMatches = 0;
+    m_searchPattern = re;
+    m_reportNoMatches = reportNoMatches;
+
+    m_searchFields = {};
+    if (m_ui->summaryCheck->isChecked()) {
+        m_searchFields |= SearchIndex::Summary;
+    }
+    if (m_ui->descriptionCheck->isChecked()) {
+        m_searchFields |= SearchIndex::Description;
+    }
+    if (m_ui->categoryCheck->isChecked()) {
+        m_searchFields |= SearchIndex::Categories;
+    }
+    if (m_ui->locationCheck->isChecked()) {
+        m_searchFields |= SearchIndex::Location;
+    }
+    if (m_ui->attendeeCheck->isChecked()) {
+        m_searchFields |= SearchIndex::Attendees;
+    }
+
+    // Only the incidences containing the words of the pattern can match it
+    QSet<QString> candidates;
+    const bool useIndex = m_searchIndex->candidates(re.pattern(), m_searchFields, candidates);
+
+    if (!m_searchFields || (useIndex && candidates.isEmpty())) {
+        finishSearch();
+        return;
+    }
+
     const QDate startDt = m_ui->startDate->date();
     const QDate endDt = m_ui->endDate->date();
 
@@ -171,80 +215,118 @@ void SearchDialog::search(const QRegExp &re)
         events = m_calendarview->calendar()->events(startDt, endDt, QTimeZone::systemTimeZone(), m_ui->inclusiveCheck->isChecked());
     }
 
-    KCalendarCore::Todo::List todos;
+    auto inRange = [startDt, endDt](const QDateTime &dt) {
+        const QDate date = dt.toLocalTime().date();
+        return date >= startDt && date <= endDt;
+    };
 
+    // A single pass over all to-dos and journals, whatever the length of the range
+    KCalendarCore::Todo::List todos;
     if (m_ui->todosCheck->isChecked()) {
-        if (m_ui->includeUndatedTodos->isChecked()) {
-            const KCalendarCore::Todo::List alltodos = m_calendarview->calendar()->todos();
-            for (const KCalendarCore::Todo::Ptr &todo : alltodos) {
-                Q_ASSERT(todo);
-                if ((!todo->hasStartDate() && !todo->hasDueDate()) // undated
-                    || (todo->hasStartDate() && (todo->dtStart().toLocalTime().date() >= startDt)
-                        && (todo->dtStart().toLocalTime().date() <= endDt)) // start dt in range
-                    || (todo->hasDueDate() && (todo->dtDue().toLocalTime().date() >= startDt)
-                        && (todo->dtDue().toLocalTime().date() <= endDt)) // due dt in range
-                    || (todo->hasCompletedDate() && (todo->completed().toLocalTime().date() >= startDt)
-                        && (todo->completed().toLocalTime().date() <= endDt))) { // completed dt in range
-                    todos.append(todo);
-                }
-            }
-        } else {
-            QDate dt = startDt;
-            while (dt <= endDt) {
-                todos += m_calendarview->calendar()->todos(dt);
-                dt = dt.addDays(1);
+        const bool includeUndated = m_ui->includeUndatedTodos->isChecked();
+        const QDateTime rangeStart(startDt, QTime(0, 0));
+        const QDateTime rangeEnd(endDt, QTime(23, 59, 59));
+        const KCalendarCore::Todo::List alltodos = m_calendarview->calendar()->todos();
+        for (const KCalendarCore::Todo::Ptr &todo : alltodos) {
+            Q_ASSERT(todo);
+            if ((includeUndated && !todo->hasStartDate() && !todo->hasDueDate()) // undated
+                || (todo->hasStartDate() && inRange(todo->dtStart())) // start dt in range
+                || (todo->hasDueDate() && inRange(todo->dtDue())) // due dt in range
+                || (todo->hasCompletedDate() && inRange(todo->completed())) // completed dt in range
+                || (todo->recurs() && !todo->recurrence()->timesInInterval(rangeStart, rangeEnd).isEmpty())) { // recurs in range
+                todos.append(todo);
             }
         }
     }
 
     KCalendarCore::Journal::List journals;
     if (m_ui->journalsCheck->isChecked()) {
-        QDate dt = startDt;
-        while (dt <= endDt) {
-            journals += m_calendarview->calendar()->journals(dt);
-            dt = dt.addDays(1);
+        const KCalendarCore::Journal::List alljournals = m_calendarview->calendar()->journals();
+        for (const KCalendarCore::Journal::Ptr &journal : alljournals) {
+            if (inRange(journal->dtStart())) {
+                journals.append(journal);
+            }
         }
     }
 
-    m_matchedEvents.clear();
+    // The incidences are checked in slices, so that the dialog stays responsive
     const KCalendarCore::Incidence::List incidences = Akonadi::ETMCalendar::mergeIncidenceList(events, todos, journals);
+    m_pendingIncidences.reserve(useIndex ? candidates.size() : incidences.size());
     for (const KCalendarCore::Incidence::Ptr &ev : incidences) {
         Q_ASSERT(ev);
-        Akonadi::Item item = m_calendarview->calendar()->item(ev->uid());
-        if (m_ui->summaryCheck->isChecked()) {
-            if (re.indexIn(ev->summary()) != -1) {
-                m_matchedEvents.append(item);
-                continue;
-            }
-        }
-        if (m_ui->descriptionCheck->isChecked()) {
-            if (re.indexIn(ev->description()) != -1) {
-                m_matchedEvents.append(item);
-                continue;
-            }
+        if (!useIndex || candidates.contains(ev->instanceIdentifier())) {
+            m_pendingIncidences.append(ev);
         }
-        if (m_ui->categoryCheck->isChecked()) {
-            if (re.indexIn(ev->categoriesStr()) != -1) {
-                m_matchedEvents.append(item);
-                continue;
-            }
-        }
-        if (m_ui->locationCheck->isChecked()) {
-            if (re.indexIn(ev->location()) != -1) {
+    }
+    m_lastShown.start();
+    m_searchTimer->start();
+}
+
+void SearchDialog::searchSlice()
+{
+    QElapsedTimer elapsed;
+    elapsed.start();
+    const int count = m_pendingIncidences.count();
+    while (m_pendingIndex < count && elapsed.elapsed() < s_searchSliceTime) {
+        const KCalendarCore::Incidence::Ptr &ev = m_pendingIncidences.at(m_pendingIndex++);
+        if (matches(m_searchPattern, ev, m_searchFields)) {
+            const Akonadi::Item item = m_calendarview->calendar()->item(ev);
+            if (item.isValid()) { // may have been removed meanwhile
                 m_matchedEvents.append(item);
-                continue;
             }
         }
-        if (m_ui->attendeeCheck->isChecked()) {
-            const KCalendarCore::Attendee::List lstAttendees = ev->attendees();
-            for (const KCalendarCore::Attendee &attendee : lstAttendees) {
-                if (re.indexIn(attendee.fullName()) != -1) {
-                    m_matchedEvents.append(item);
-                    break;
-                }
+    }
+
+    if (m_pendingIndex >= count) {
+        finishSearch();
+    } else if (m_matchedEvents.count() > m_shownMatches && m_lastShown.elapsed() >= s_searchUpdateInterval) {
+        showMatches();
+    }
+}
+
+void SearchDialog::showMatches()
+{
+    m_listView->showIncidences(m_matchedEvents, QDate());
+    m_shownMatches = m_matchedEvents.count();
+    m_lastShown.start();
+    updateMatchesText();
+}
+
+void SearchDialog::finishSearch()
+{
+    cancelSearch();
+    showMatches();
+    if (m_reportNoMatches && m_matchedEvents.isEmpty()) {
+        KMessageBox::information(this,
+                                 i18nc("@info", "No items were found that match your search pattern."),
+                                 i18nc("@title:window", "Search Results"),
+                                 QStringLiteral("NoSearchResults"));
+    }
+}
+
+bool SearchDialog::matches(const QRegExp &re, const KCalendarCore::Incidence::Ptr &incidence, int fields) const
+{
+    if ((fields & SearchIndex::Summary) && re.indexIn(incidence->summary()) != -1) {
+        return true;
+    }
+    if ((fields & SearchIndex::Description) && re.indexIn(incidence->description()) != -1) {
+        return true;
+    }
+    if ((fields & SearchIndex::Categories) && re.indexIn(incidence->categoriesStr()) != -1) {
+        return true;
+    }
+    if ((fields & SearchIndex::Location) && re.indexIn(incidence->location()) != -1) {
+        return true;
+    }
+    if (fields & SearchIndex::Attendees) {
+        const KCalendarCore::Attendee::List lstAttendees = incidence->attendees();
+        for (const KCalendarCore::Attendee &attendee : lstAttendees) {
+            if (re.indexIn(attendee.fullName()) != -1) {
+                return true;
             }
         }
     }
+    return false;
 }
 
 void SearchDialog::readConfig()
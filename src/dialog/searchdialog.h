@@ -10,11 +10,19 @@
 
 #pragma once
 
+#include "searchindex.h"
+
 #include <Akonadi/Item>
+#include <KCalendarCore/Incidence>
 
 #include <QDialog>
+#include <QElapsedTimer>
+#include <QRegExp>
+
+#include <memory>
 
 class QPushButton;
+class QTimer;
 class CalendarView;
 class KOEventPopupMenu;
 
@@ -28,11 +36,6 @@ namespace EventViews
 class ListView;
 }
 
-namespace KCalendarCore
-{
-class Incidence;
-}
-
 class SearchDialog : public QDialog
 {
     Q_OBJECT
@@ -58,13 +61,34 @@ protected:
 private:
     void doSearch();
     void searchPatternChanged(const QString &pattern);
-    void search(const QRegExp &re);
+    /**
+      Starts searching for @p re, replacing the search in progress. The matches
+      are shown while the search goes on; if @p reportNoMatches is true, the
+      user is told when nothing was found.
+    */
+    void search(const QRegExp &re, bool reportNoMatches);
+    void cancelSearch();
+    void searchSlice();
+    void showMatches();
+    void finishSearch();
+    /** Returns whether @p re matches one of the SearchIndex::Fields @p fields of @p incidence. */
+    Q_REQUIRED_RESULT bool matches(const QRegExp &re, const KCalendarCore::Incidence::Ptr &incidence, int fields) const;
     void readConfig();
     void writeConfig();
     void updateMatchesText();
 
     Ui::SearchDialog *const m_ui;
     CalendarView *const m_calendarview; // parent
+    const std::unique_ptr<SearchIndex> m_searchIndex;
+    QTimer *const m_searchTimer;
+    QRegExp m_searchPattern;
+    SearchIndex::Fields m_searchFields;
+    /** the incidences of the running search which are still to be checked, from m_pendingIndex on */
+    KCalendarCore::Incidence::List m_pendingIncidences;
+    int m_pendingIndex = 0;
+    int m_shownMatches = 0;
+    bool m_reportNoMatches = false;
+    QElapsedTimer m_lastShown;
     KOEventPopupMenu *m_popupMenu = nullptr;
     Akonadi::Item::List m_matchedEvents;
     EventViews::ListView *m_listView = nullptr;
@@ -0,0 +1,236 @@
+/*
+  This file is part of KOrganizer.
+
+  SPDX-FileCopyrightText: 2026 KOrganizer Developers
+
+  SPDX-License-Identifier: GPL-2.0-or-later WITH Qt-Commercial-exception-1.0
+*/
+
+#include "searchindex.h"
+
+#include <QVector>
+
+#include <algorithm>
+
+using namespace KCalendarCore;
+
+namespace
+{
+struct Term {
+    QString word;
+    bool atStart; // the word starts a word of the text
+    bool atEnd; // the word ends a word of the text
+};
+
+// A character of a wildcard pattern which only matches itself and is no word character
+bool isLiteralSeparator(QChar c)
+{
+    return !c.isLetterOrNumber() && c != QLatin1Char('*') && c != QLatin1Char('?') && c != QLatin1Char('[') && c != QLatin1Char(']');
+}
+
+// Splits a wildcard pattern into the words a matching text has to contain
+QVector<Term> patternTerms(const QString &pattern)
+{
+    QVector<Term> terms;
+    const QString folded = pattern.toCaseFolded();
+    const int length = folded.length();
+    int i = 0;
+    while (i < length) {
+        const QChar c = folded.at(i);
+        if (c == QLatin1Char('[')) {
+            // a set of characters matches a single unknown one
+            const int close = folded.indexOf(QLatin1Char(']'), i + 1);
+            i = close < 0 ? length : close + 1;
+            continue;
+        }
+        if (!c.isLetterOrNumber()) {
+            ++i;
+            continue;
+        }
+        int j = i;
+        while (j < length && folded.at(j).isLetterOrNumber()) {
+            ++j;
+        }
+        // the pattern is not anchored, so a word at either end may be part of a longer one
+        Term term;
+        term.word = folded.mid(i, j - i);
+        term.atStart = i > 0 && isLiteralSeparator(folded.at(i - 1));
+        term.atEnd = j < length && isLiteralSeparator(folded.at(j));
+        terms.append(term);
+        i = j;
+    }
+
+    // look up the cheapest and most selective words first
+    std::sort(terms.begin(), terms.end(), [](const Term &lhs, const Term &rhs) {
+        if (lhs.atStart != rhs.atStart) {
+            return lhs.atStart;
+        }
+        return lhs.word.length() > rhs.word.length();
+    });
+    return terms;
+}
+}
+
+SearchIndex::SearchIndex(const Akonadi::ETMCalendar::Ptr &calendar)
+    : mCalendar(calendar)
+{
+    mCalendar->registerObserver(this);
+}
+
+SearchIndex::~SearchIndex()
+{
+    mCalendar->unregisterObserver(this);
+}
+
+bool SearchIndex::candidates(const QString &pattern, Fields fields, QSet<QString> &result)
+{
+    result.clear();
+    const QVector<Term> terms = patternTerms(pattern);
+    if (terms.isEmpty()) {
+        return false;
+    }
+
+    if (mDirty) {
+        rebuild();
+    }
+
+    bool first = true;
+    for (const Term &term : terms) {
+        QSet<QString> ids;
+        if (term.atStart && term.atEnd) {
+            const auto it = mWords.constFind(term.word);
+            if (it != mWords.cend()) {
+                collect(it.value(), fields, ids);
+            }
+        } else if (term.atStart) {
+            const auto end = mWords.cend();
+            for (auto it = std::as_const(mWords).lowerBound(term.word); it != end && it.key().startsWith(term.word); ++it) {
+                collect(it.value(), fields, ids);
+            }
+        } else {
+            const auto end = mWords.cend();
+            for (auto it = mWords.cbegin(); it != end; ++it) {
+                if (term.atEnd ? it.key().endsWith(term.word) : it.key().contains(term.word)) {
+                    collect(it.value(), fields, ids);
+                }
+            }
+        }
+
+        if (first) {
+            result = ids;
+            first = false;
+        } else {
+            result.intersect(ids);
+        }
+        if (result.isEmpty()) {
+            break;
+        }
+    }
+    return true;
+}
+
+QStringList SearchIndex::words(const QString &text)
+{
+    QStringList words;
+    const QString folded = text.toCaseFolded();
+    const int length = folded.length();
+    int start = -1;
+    for (int i = 0; i <= length; ++i) {
+        if (i < length && folded.at(i).isLetterOrNumber()) {
+            if (start < 0) {
+                start = i;
+            }
+        } else if (start >= 0) {
+            words.append(folded.mid(start, i - start));
+            start = -1;
+        }
+    }
+    return words;
+}
+
+void SearchIndex::calendarIncidenceAdded(const Incidence::Ptr &incidence)
+{
+    if (!mDirty) {
+        insert(incidence);
+    }
+}
+
+void SearchIndex::calendarIncidenceChanged(const Incidence::Ptr &incidence)
+{
+    if (!mDirty) {
+        remove(incidence->instanceIdentifier());
+        insert(incidence);
+    }
+}
+
+void SearchIndex::calendarIncidenceDeleted(const Incidence::Ptr &incidence, const KCalendarCore::Calendar *calendar)
+{
+    Q_UNUSED(calendar)
+    if (!mDirty) {
+        remove(incidence->instanceIdentifier());
+    }
+}
+
+void SearchIndex::rebuild()
+{
+    mWords.clear();
+    mEntries.clear();
+    const Incidence::List incidences = mCalendar->rawIncidences();
+    for (const Incidence::Ptr &incidence : incidences) {
+        insert(incidence);
+    }
+    mDirty = false;
+}
+
+void SearchIndex::insert(const Incidence::Ptr &incidence)
+{
+    QHash<QString, int> fieldsByWord;
+    auto add = [&fieldsByWord](const QString &text, Field field) {
+        const QStringList textWords = words(text);
+        for (const QString &word : textWords) {
+            fieldsByWord[word] |= field;
+        }
+    };
+    add(incidence->summary(), Summary);
+    add(incidence->description(), Description);
+    add(incidence->categoriesStr(), Categories);
+    add(incidence->location(), Location);
+    const Attendee::List attendees = incidence->attendees();
+    for (const Attendee &attendee : attendees) {
+        add(attendee.fullName(), Attendees);
+    }
+
+    const QString id = incidence->instanceIdentifier();
+    for (auto it = fieldsByWord.cbegin(), end = fieldsByWord.cend(); it != end; ++it) {
+        mWords[it.key()].insert(id, it.value());
+    }
+    mEntries.insert(id, fieldsByWord.keys());
+}
+
+void SearchIndex::remove(const QString &instanceIdentifier)
+{
+    const auto entry = mEntries.find(instanceIdentifier);
+    if (entry == mEntries.end()) {
+        return;
+    }
+
+    for (const QString &word : std::as_const(*entry)) {
+        const auto it = mWords.find(word);
+        if (it != mWords.end()) {
+            it->remove(instanceIdentifier);
+            if (it->isEmpty()) {
+                mWords.erase(it);
+            }
+        }
+    }
+    mEntries.erase(entry);
+}
+
+void SearchIndex::collect(const Postings &postings, Fields fields, QSet<QString> &ids) const
+{
+    for (auto it = postings.cbegin(), end = postings.cend(); it != end; ++it) {
+        if (it.value() & fields) {
+            ids.insert(it.key());
+        }
+    }
+}
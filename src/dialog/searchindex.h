@@ -0,0 +1,81 @@
+/*
+  This file is part of KOrganizer.
+
+  SPDX-FileCopyrightText: 2026 KOrganizer Developers
+
+  SPDX-License-Identifier: GPL-2.0-or-later WITH Qt-Commercial-exception-1.0
+*/
+
+#pragma once
+
+#include <Akonadi/Calendar/ETMCalendar>
+
+#include <QHash>
+#include <QMap>
+#include <QSet>
+#include <QStringList>
+
+/**
+ * An inverted index of the words of the searchable texts of the incidences
+ * of a calendar, used by the search dialog to find the incidences which may
+ * match a wildcard pattern without running the pattern over all of them.
+ *
+ * The words are case folded runs of letters and digits. Every run of letters
+ * and digits of a pattern must be part of a word of a matching incidence, so
+ * each of them is looked up in the sorted dictionary: exactly, by prefix, or,
+ * when it may be in the middle of a word, by scanning the dictionary, which is
+ * much smaller than the indexed texts. The returned candidates still have to
+ * be checked against the pattern.
+ *
+ * The index is built on the first lookup and then kept up to date through
+ * the calendar observer interface.
+ */
+class SearchIndex : public Akonadi::ETMCalendar::CalendarObserver
+{
+public:
+    enum Field {
+        Summary = 0x01,
+        Description = 0x02,
+        Categories = 0x04,
+        Location = 0x08,
+        Attendees = 0x10,
+    };
+    Q_DECLARE_FLAGS(Fields, Field)
+
+    explicit SearchIndex(const Akonadi::ETMCalendar::Ptr &calendar);
+    ~SearchIndex() override;
+
+    /**
+      Collects the instance identifiers of the incidences which may match the
+      wildcard @p pattern in one of @p fields into @p candidates.
+      Returns false if the pattern contains no letters or digits, in which case
+      every incidence is a candidate.
+    */
+    Q_REQUIRED_RESULT bool candidates(const QString &pattern, Fields fields, QSet<QString> &candidates);
+
+    /** Returns the case folded runs of letters and digits of @p text. */
+    Q_REQUIRED_RESULT static QStringList words(const QString &text);
+
+    void calendarIncidenceAdded(const KCalendarCore::Incidence::Ptr &incidence) override;
+    void calendarIncidenceChanged(const KCalendarCore::Incidence::Ptr &incidence) override;
+    void calendarIncidenceDeleted(const KCalendarCore::Incidence::Ptr &incidence, const KCalendarCore::Calendar *calendar) override;
+
+private:
+    /** the fields a word was found in, keyed by instance identifier */
+    using Postings = QHash<QString, int>;
+
+    void rebuild();
+    void insert(const KCalendarCore::Incidence::Ptr &incidence);
+    void remove(const QString &instanceIdentifier);
+    void collect(const Postings &postings, Fields fields, QSet<QString> &ids) const;
+
+    Akonadi::ETMCalendar::Ptr mCalendar;
+
+    /** the dictionary, sorted for prefix lookups */
+    QMap<QString, Postings> mWords;
+    /** the words of each incidence, keyed by instance identifier */
+    QHash<QString, QStringList> mEntries;
+    bool mDirty = true;
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(SearchIndex::Fields)
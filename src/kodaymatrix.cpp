@@ -12,10 +12,13 @@
 
 #include "kodaymatrix.h"
 #include "koglobals.h"
+#include "occurrencecache.h"
 #include "prefs/koprefs.h"
 
 #include <CalendarSupport/Utils>
 
+#include <KCalendarCore/CalFilter>
+
 #include <Akonadi/ItemFetchJob>
 #include <Akonadi/ItemFetchScope>
 
@@ -28,13 +31,16 @@
 #include <QMouseEvent>
 #include <QPainter>
 #include <QToolTip>
+#include <QtAlgorithms>
+
+#include <algorithm>
 
 // ============================================================================
 //  K O D A Y M A T R I X
 // ============================================================================
 
 const int KODayMatrix::NOSELECTION = -1000;
-const int KODayMatrix::NUMDAYS = 42;
+constexpr int KODayMatrix::NUMDAYS;
 
 KODayMatrix::KODayMatrix(QWidget *parent)
     : QFrame(parent)
@@ -68,6 +74,12 @@ void KODayMatrix::setCalendar(const Akonadi::ETMCalendar::Ptr &calendar)
     updateIncidences();
 }
 
+void KODayMatrix::setOccurrenceCache(OccurrenceCache *cache)
+{
+    mOccurrenceCache = cache;
+    mPendingChanges = true;
+}
+
 QColor KODayMatrix::getShadedColor(const QColor &color) const
 {
     QColor shaded;
@@ -143,10 +155,18 @@ void KODayMatrix::recalculateToday()
     }
 
     mToday = -1;
+    mShadedDays = 0;
+    // days before the first and after the last day of the displayed month are shaded
+    bool shaded = true;
     for (int i = 0; i < NUMDAYS; ++i) {
         mDays[i] = mStartDate.addDays(i);
         mDayLabels[i] = QString::number(mDays[i].day());
 
+        if (mDays[i].day() == 1) {
+            shaded = !shaded;
+        }
+        mShadedDays |= DayMask(shaded) << i;
+
         // if today is in the currently displayed month, highlight today
         if (mDays[i].year() == QDate::currentDate().year() && mDays[i].month() == QDate::currentDate().month()
             && mDays[i].day() == QDate::currentDate().day()) {
@@ -202,6 +222,11 @@ void KODayMatrix::updateView(QDate actdate)
         recalculateToday();
     }
 
+    // The calendar doesn't tell its observers about a new filter
+    if (mCalendar && mCalendar->filter() != mFilter) {
+        mPendingChanges = true;
+    }
+
     // The calendar has not changed in the meantime and the selected range
     // is still the same so we can save the expensive updateIncidences() call
     if (!daychanged && !mPendingChanges) {
@@ -228,15 +253,27 @@ void KODayMatrix::updateView(QDate actdate)
         }
         mHolidays[i] = holiStr;
     }
+
+    // Days which are no work days are drawn using the holiday color
+    mHolidayDays = offsetRange(0, NUMDAYS - 1);
+    const QList<QDate> workDays = CalendarSupport::workDays(mDays[0], mDays[NUMDAYS - 1]);
+    for (const QDate &workDay : workDays) {
+        mHolidayDays &= ~offsetRange(mStartDate.daysTo(workDay), mStartDate.daysTo(workDay));
+    }
 }
 
 void KODayMatrix::updateIncidences()
 {
-    if (!mCalendar) {
+    if (!mCalendar || !mStartDate.isValid()) {
         return;
     }
 
-    mEvents.clear();
+    for (auto &counts : mOccupancy) {
+        std::fill(std::begin(counts), std::end(counts), 0);
+    }
+    std::fill(std::begin(mIncidenceDays), std::end(mIncidenceDays), 0);
+    mIndexedIncidences.clear();
+    mFilter = mCalendar->filter();
 
     if (mHighlightEvents) {
         updateEvents();
@@ -255,18 +292,10 @@ void KODayMatrix::updateIncidences()
 
 void KODayMatrix::updateJournals()
 {
-    const KCalendarCore::Incidence::List incidences = mCalendar->incidences();
-
-    for (const KCalendarCore::Incidence::Ptr &inc : incidences) {
-        Q_ASSERT(inc);
-        QDate d = inc->dtStart().toLocalTime().date();
-        if (inc->type() == KCalendarCore::Incidence::TypeJournal && d >= mDays[0] && d <= mDays[NUMDAYS - 1] && !mEvents.contains(d)) {
-            mEvents.append(d);
-        }
-        if (mEvents.count() == NUMDAYS) {
-            // No point in wasting cpu, all days are bold already
-            break;
-        }
+    const KCalendarCore::Journal::List journals = mCalendar->journals();
+    for (const KCalendarCore::Journal::Ptr &journal : journals) {
+        Q_ASSERT(journal);
+        indexIncidence(journal);
     }
 }
 
@@ -281,103 +310,186 @@ void KODayMatrix::updateJournals()
  */
 void KODayMatrix::updateTodos()
 {
-    const KCalendarCore::Todo::List incidences = mCalendar->todos();
-    QDate d;
-    for (const KCalendarCore::Todo::Ptr &t : incidences) {
-        if (mEvents.count() == NUMDAYS) {
-            // No point in wasting cpu, all days are bold already
-            break;
-        }
-        Q_ASSERT(t);
-        if (t->hasDueDate()) {
-            ushort recurType = t->recurrenceType();
-
-            if (t->recurs() && !(recurType == KCalendarCore::Recurrence::rDaily && !KOPrefs::instance()->mDailyRecur)
-                && !(recurType == KCalendarCore::Recurrence::rWeekly && !KOPrefs::instance()->mWeeklyRecur)) {
-                // It's a recurring todo, find out in which days it occurs
-                const auto timeDateList =
-                    t->recurrence()->timesInInterval(QDateTime(mDays[0], {}, Qt::LocalTime), QDateTime(mDays[NUMDAYS - 1], {}, Qt::LocalTime));
-
-                for (const QDateTime &dt : timeDateList) {
-                    d = dt.toLocalTime().date();
-                    if (!mEvents.contains(d)) {
-                        mEvents.append(d);
-                    }
-                }
-            } else {
-                d = t->dtDue().toLocalTime().date();
-                if (d >= mDays[0] && d <= mDays[NUMDAYS - 1] && !mEvents.contains(d)) {
-                    mEvents.append(d);
-                }
-            }
-        }
+    const KCalendarCore::Todo::List todos = mCalendar->todos();
+    for (const KCalendarCore::Todo::Ptr &todo : todos) {
+        Q_ASSERT(todo);
+        indexIncidence(todo);
     }
 }
 
 void KODayMatrix::updateEvents()
 {
-    if (mEvents.count() == NUMDAYS) {
-        mPendingChanges = false;
-        // No point in wasting cpu, all days are bold already
+    const KCalendarCore::Event::List eventlist = mCalendar->events(mDays[0], mDays[NUMDAYS - 1], mCalendar->timeZone());
+    for (const KCalendarCore::Event::Ptr &event : eventlist) {
+        Q_ASSERT(event);
+        indexIncidence(event);
+    }
+}
+
+void KODayMatrix::indexIncidence(const KCalendarCore::Incidence::Ptr &incidence)
+{
+    const IncidenceKind kind = highlightedKind(incidence);
+    if (kind == IncidenceKindCount) {
         return;
     }
-    const KCalendarCore::Event::List eventlist = mCalendar->events(mDays[0], mDays[NUMDAYS - 1], mCalendar->timeZone());
 
-    for (const KCalendarCore::Event::Ptr &event : eventlist) {
-        if (mEvents.count() == NUMDAYS) {
-            // No point in wasting cpu, all days are bold already
-            break;
+    DayMask days = 0;
+    switch (kind) {
+    case EventKind:
+        days = eventDays(incidence.staticCast<KCalendarCore::Event>());
+        break;
+    case TodoKind:
+        days = todoDays(incidence.staticCast<KCalendarCore::Todo>());
+        break;
+    case JournalKind:
+        days = journalDays(incidence.staticCast<KCalendarCore::Journal>());
+        break;
+    case IncidenceKindCount:
+        break;
+    }
+    if (!days) {
+        return;
+    }
+
+    for (DayMask remaining = days; remaining; remaining &= remaining - 1) {
+        ++mOccupancy[kind][qCountTrailingZeroBits(remaining)];
+    }
+    mIncidenceDays[kind] |= days;
+    mIndexedIncidences.insert(incidence->instanceIdentifier(), {kind, days});
+}
+
+void KODayMatrix::unindexIncidence(const KCalendarCore::Incidence::Ptr &incidence)
+{
+    const auto it = mIndexedIncidences.find(incidence->instanceIdentifier());
+    if (it == mIndexedIncidences.end()) {
+        return;
+    }
+
+    const IndexEntry entry = it.value();
+    mIndexedIncidences.erase(it);
+    for (DayMask remaining = entry.days; remaining; remaining &= remaining - 1) {
+        const int offset = qCountTrailingZeroBits(remaining);
+        if (--mOccupancy[entry.kind][offset] == 0) {
+            mIncidenceDays[entry.kind] &= ~(DayMask(1) << offset);
         }
+    }
+}
 
-        Q_ASSERT(event);
-        const ushort recurType = event->recurrenceType();
-        const QDateTime dtStart = event->dtStart().toLocalTime();
-
-        // timed incidences occur in
-        //   [dtStart(), dtEnd()[. All-day incidences occur in [dtStart(), dtEnd()]
-        // so we subtract 1 second in the timed case
-        const int secsToAdd = event->allDay() ? 0 : -1;
-        const QDateTime dtEnd = event->dtEnd().toLocalTime().addSecs(secsToAdd);
-
-        if (!(recurType == KCalendarCore::Recurrence::rDaily && !KOPrefs::instance()->mDailyRecur)
-            && !(recurType == KCalendarCore::Recurrence::rWeekly && !KOPrefs::instance()->mWeeklyRecur)) {
-            KCalendarCore::DateTimeList timeDateList;
-            const bool isRecurrent = event->recurs();
-            const int eventDuration = dtStart.daysTo(dtEnd);
-
-            if (isRecurrent) {
-                // Its a recurring event, find out in which days it occurs
-                timeDateList = event->recurrence()->timesInInterval(QDateTime(mDays[0], {}, Qt::LocalTime), QDateTime(mDays[NUMDAYS - 1], {}, Qt::LocalTime));
-            } else {
-                if (dtStart.date() >= mDays[0]) {
-                    timeDateList.append(dtStart);
-                } else {
-                    // The event starts in another month (not visible))
-                    timeDateList.append(QDateTime(mDays[0], {}, Qt::LocalTime));
-                }
-            }
+KODayMatrix::IncidenceKind KODayMatrix::highlightedKind(const KCalendarCore::Incidence::Ptr &incidence) const
+{
+    switch (incidence->type()) {
+    case KCalendarCore::Incidence::TypeEvent:
+        return mHighlightEvents ? EventKind : IncidenceKindCount;
+    case KCalendarCore::Incidence::TypeTodo:
+        return mHighlightTodos ? TodoKind : IncidenceKindCount;
+    case KCalendarCore::Incidence::TypeJournal:
+        return mHighlightJournals ? JournalKind : IncidenceKindCount;
+    default:
+        return IncidenceKindCount;
+    }
+}
 
-            for (auto t = timeDateList.begin(); t != timeDateList.end(); ++t) {
-                // This could be a multiday event, so iterate from dtStart() to dtEnd()
-                QDate d = t->toLocalTime().date();
-                int j = 0;
+KCalendarCore::DateTimeList KODayMatrix::occurrences(const KCalendarCore::Incidence::Ptr &incidence) const
+{
+    const QDateTime start(mDays[0], {}, Qt::LocalTime);
+    const QDateTime end(mDays[NUMDAYS - 1], {}, Qt::LocalTime);
+    if (mOccurrenceCache) {
+        return mOccurrenceCache->timesInInterval(incidence, start, end);
+    }
+    return incidence->recurrence()->timesInInterval(start, end);
+}
 
-                QDate occurrenceEnd;
-                if (isRecurrent) {
-                    occurrenceEnd = d.addDays(eventDuration);
-                } else {
-                    occurrenceEnd = dtEnd.date();
-                }
+KODayMatrix::DayMask KODayMatrix::eventDays(const KCalendarCore::Event::Ptr &event) const
+{
+    const ushort recurType = event->recurrenceType();
+    if ((recurType == KCalendarCore::Recurrence::rDaily && !KOPrefs::instance()->mDailyRecur)
+        || (recurType == KCalendarCore::Recurrence::rWeekly && !KOPrefs::instance()->mWeeklyRecur)) {
+        return 0;
+    }
 
-                do {
-                    mEvents.append(d);
-                    ++j;
-                    d = d.addDays(1);
-                } while (d <= occurrenceEnd && j < NUMDAYS);
-            }
+    const QDateTime dtStart = event->dtStart().toLocalTime();
+
+    // timed incidences occur in
+    //   [dtStart(), dtEnd()[. All-day incidences occur in [dtStart(), dtEnd()]
+    // so we subtract 1 second in the timed case
+    const int secsToAdd = event->allDay() ? 0 : -1;
+    const QDateTime dtEnd = event->dtEnd().toLocalTime().addSecs(secsToAdd);
+
+    if (!event->recurs()) {
+        return dayRange(dtStart.date(), dtEnd.date());
+    }
+
+    // Its a recurring event, find out in which days it occurs
+    DayMask days = 0;
+    const int eventDuration = dtStart.daysTo(dtEnd);
+    const auto timeDateList = occurrences(event);
+    for (const QDateTime &dt : timeDateList) {
+        // This could be a multiday event, so mark every day of the occurrence
+        const QDate d = dt.toLocalTime().date();
+        days |= dayRange(d, d.addDays(eventDuration));
+    }
+    return days;
+}
+
+KODayMatrix::DayMask KODayMatrix::todoDays(const KCalendarCore::Todo::Ptr &todo) const
+{
+    if (!todo->hasDueDate()) {
+        return 0;
+    }
+
+    const ushort recurType = todo->recurrenceType();
+    if (todo->recurs() && !(recurType == KCalendarCore::Recurrence::rDaily && !KOPrefs::instance()->mDailyRecur)
+        && !(recurType == KCalendarCore::Recurrence::rWeekly && !KOPrefs::instance()->mWeeklyRecur)) {
+        // It's a recurring todo, find out in which days it occurs
+        DayMask days = 0;
+        const auto timeDateList = occurrences(todo);
+        for (const QDateTime &dt : timeDateList) {
+            const QDate d = dt.toLocalTime().date();
+            days |= dayRange(d, d);
         }
+        return days;
     }
-    mPendingChanges = false;
+
+    const QDate d = todo->dtDue().toLocalTime().date();
+    return dayRange(d, d);
+}
+
+KODayMatrix::DayMask KODayMatrix::journalDays(const KCalendarCore::Journal::Ptr &journal) const
+{
+    const QDate d = journal->dtStart().toLocalTime().date();
+    return dayRange(d, d);
+}
+
+KODayMatrix::DayMask KODayMatrix::dayRange(QDate from, QDate to) const
+{
+    const qint64 first = mStartDate.daysTo(from);
+    return offsetRange(first, qMax(first, mStartDate.daysTo(to)));
+}
+
+KODayMatrix::DayMask KODayMatrix::offsetRange(qint64 first, qint64 last)
+{
+    first = qMax<qint64>(0, first);
+    last = qMin<qint64>(NUMDAYS - 1, last);
+    if (first > last) {
+        return 0;
+    }
+    return (~DayMask(0) >> (63 - last)) & (~DayMask(0) << first);
+}
+
+KODayMatrix::DayMask KODayMatrix::selectedDays() const
+{
+    if (mSelStart == NOSELECTION) {
+        return 0;
+    }
+    return offsetRange(mSelStart, mSelEnd);
+}
+
+bool KODayMatrix::hasIncidences(int offset) const
+{
+    if (offset < 0 || offset > NUMDAYS - 1) {
+        return false;
+    }
+    return (mIncidenceDays[EventKind] | mIncidenceDays[TodoKind] | mIncidenceDays[JournalKind]) & (DayMask(1) << offset);
 }
 
 const QDate &KODayMatrix::getDate(int offset) const
@@ -403,21 +515,30 @@ int KODayMatrix::getDayIndexFrom(int x, int y) const
 
 void KODayMatrix::calendarIncidenceAdded(const KCalendarCore::Incidence::Ptr &incidence)
 {
-    Q_UNUSED(incidence)
-    mPendingChanges = true;
+    // an incidence which is added again simply replaces its previous days
+    calendarIncidenceChanged(incidence);
 }
 
 void KODayMatrix::calendarIncidenceChanged(const KCalendarCore::Incidence::Ptr &incidence)
 {
-    Q_UNUSED(incidence)
-    mPendingChanges = true;
+    // if a full update is pending anyway there is no point in updating the index now
+    if (mPendingChanges || !mStartDate.isValid()) {
+        return;
+    }
+    unindexIncidence(incidence);
+    if (mCalendar && mCalendar->filter() && !mCalendar->filter()->filterIncidence(incidence)) {
+        return;
+    }
+    indexIncidence(incidence);
 }
 
 void KODayMatrix::calendarIncidenceDeleted(const KCalendarCore::Incidence::Ptr &incidence, const KCalendarCore::Calendar *calendar)
 {
-    Q_UNUSED(incidence)
     Q_UNUSED(calendar)
-    mPendingChanges = true;
+    if (mPendingChanges || !mStartDate.isValid()) {
+        return;
+    }
+    unindexIncidence(incidence);
 }
 
 void KODayMatrix::setHighlightMode(bool highlightEvents, bool highlightTodos, bool highlightJournals)
@@ -736,92 +857,41 @@ void KODayMatrix::paintEvent(QPaintEvent *)
 
     // iterate over all days in the matrix and draw the day label in appropriate colors
     const QColor textColor = pal.color(QPalette::Text);
-    const QColor textColorShaded = getShadedColor(textColor);
-    QColor actcol = textColorShaded;
-    p.setPen(actcol);
-    QPen tmppen;
+    const QColor holidayColor = KOPrefs::instance()->agendaHolidaysBackgroundColor();
+    // colors of the day labels, indexed by [shaded][holiday]
+    const QColor dayColors[2][2] = {{textColor, holidayColor}, {getShadedColor(textColor), getShadedColor(holidayColor)}};
+    // fonts of the day labels, indexed by [has incidences]
+    QFont dayFonts[2] = {font(), font()};
+    dayFonts[1].setBold(true);
+
+    const DayMask occupiedDays = mIncidenceDays[EventKind] | mIncidenceDays[TodoKind] | mIncidenceDays[JournalKind];
+    const DayMask selectionDays = selectedDays();
+    const DayMask todayDays = offsetRange(mToday, mToday);
 
-    const QList<QDate> workDays = CalendarSupport::workDays(mDays[0], mDays[NUMDAYS - 1]);
     for (int i = 0; i < NUMDAYS; ++i) {
         row = i / 7;
         column = isRTL ? 6 - (i - row * 7) : i - row * 7;
 
-        // if it is the first day of a month switch color from normal to shaded and vice versa
-        if (mDays[i].day() == 1) {
-            if (actcol == textColorShaded) {
-                actcol = textColor;
-            } else {
-                actcol = textColorShaded;
-            }
-            p.setPen(actcol);
-        }
-
-        // Reset pen color after selected days block
-        if (i == mSelEnd + 1) {
-            p.setPen(actcol);
-        }
-
-        const bool holiday = !workDays.contains(mDays[i]);
-
-        const QColor holidayColorShaded = getShadedColor(KOPrefs::instance()->agendaHolidaysBackgroundColor());
+        const int shaded = (mShadedDays >> i) & 1;
+        const int holiday = (mHolidayDays >> i) & 1;
+        const int selected = (selectionDays >> i) & 1;
 
         // if today then draw rectangle around day
-        if (mToday == i) {
-            tmppen = p.pen();
-            QPen todayPen(p.pen());
-
+        if ((todayDays >> i) & 1) {
+            // draw red rectangle for holidays, gray rectangle for today if in selection
+            QPen todayPen(selected ? QColor(QStringLiteral("grey")) : dayColors[shaded][holiday]);
             todayPen.setWidth(mTodayMarginWidth);
-            // draw red rectangle for holidays
-            if (holiday) {
-                if (actcol == textColor) {
-                    todayPen.setColor(KOPrefs::instance()->agendaHolidaysBackgroundColor());
-                } else {
-                    todayPen.setColor(holidayColorShaded);
-                }
-            }
-            // draw gray rectangle for today if in selection
-            if (i >= mSelStart && i <= mSelEnd) {
-                const QColor grey(QStringLiteral("grey"));
-                todayPen.setColor(grey);
-            }
             p.setPen(todayPen);
             p.drawRect(column * dayWidth, row * dayHeight, dayWidth, dayHeight);
-            p.setPen(tmppen);
         }
 
-        // if any events are on that day then draw it using a bold font
-        if (mEvents.contains(mDays[i])) {
-            QFont myFont = font();
-            myFont.setBold(true);
-            p.setFont(myFont);
-        }
+        // if any incidences are on that day then draw it using a bold font
+        p.setFont(dayFonts[(occupiedDays >> i) & 1]);
 
-        // if it is a holiday then use the default holiday color
-        if (holiday) {
-            if (actcol == textColor) {
-                p.setPen(KOPrefs::instance()->agendaHolidaysBackgroundColor());
-            } else {
-                p.setPen(holidayColorShaded);
-            }
-        }
-
-        // draw selected days with special color
-        if (i >= mSelStart && i <= mSelEnd && !holiday) {
-            p.setPen(Qt::white);
-        }
+        // draw selected days with special color, holidays with the holiday color
+        p.setPen(selected && !holiday ? QColor(Qt::white) : dayColors[shaded][holiday]);
 
         p.drawText(column * dayWidth, row * dayHeight, dayWidth, dayHeight, Qt::AlignHCenter | Qt::AlignVCenter, mDayLabels[i]);
-
-        // reset color to actual color
-        if (holiday) {
-            p.setPen(actcol);
-        }
-        // reset bold font to plain font
-        if (mEvents.contains(mDays[i]) > 0) {
-            QFont myFont = font();
-            myFont.setBold(false);
-            p.setFont(myFont);
-        }
     }
     p.end();
 }
@@ -16,6 +16,9 @@
 
 #include <QDate>
 #include <QFrame>
+#include <QHash>
+
+class OccurrenceCache;
 
 /**
  *  Replacement for kdpdatebuton.cpp that used 42 widgets for the day
@@ -76,6 +79,14 @@ public:
     */
     void setCalendar(const Akonadi::ETMCalendar::Ptr &);
 
+    /**
+      Use @p cache to expand recurring incidences, so that several matrices
+      share a single expansion pass. The cache must outlive the matrix and be
+      registered with the calendar before it. If no cache is set, recurrences
+      are expanded by the matrix itself.
+    */
+    void setOccurrenceCache(OccurrenceCache *cache);
+
     /** updates the day matrix to start with the given date. Does all the
      *  necessary checks for holidays or events on a day and stores them
      *  for display later on.
@@ -149,9 +160,16 @@ public:
         return mToday >= 27;
     }
 
+    /**
+     * Returns true if highlighted incidences occur on the day indexed by the
+     * supplied offset, which is then drawn using bold font.
+     */
+    Q_REQUIRED_RESULT bool hasIncidences(int offset) const;
+
     /**
      *  Reimplemented from Akonadi::ETMCalendar
-     *  They set mPendingChanges to true
+     *  They update the occupancy index with the changed incidence only,
+     *  unless a full update is already pending.
      */
     void calendarIncidenceAdded(const KCalendarCore::Incidence::Ptr &incidence) override;
     void calendarIncidenceChanged(const KCalendarCore::Incidence::Ptr &incidence) override;
@@ -250,22 +268,63 @@ private:
      */
     QColor getShadedColor(const QColor &color) const;
 
-    /** updates mEvent list with all days that have events */
+    /** indexes all days that have events */
     void updateEvents();
 
-    /** updates mEvent list with all days that have to-dos with due date */
+    /** indexes all days that have to-dos with due date */
     void updateTodos();
 
-    /** updates mEvent list with all days that have journals */
+    /** indexes all days that have journals */
     void updateJournals();
 
+    /** set of days of the matrix, bit i standing for the day at offset i */
+    using DayMask = quint64;
+
+    /** kinds of highlighted incidences, used to index the occupancy tables */
+    enum IncidenceKind { EventKind = 0, TodoKind, JournalKind, IncidenceKindCount };
+
+    struct IndexEntry {
+        IncidenceKind kind;
+        DayMask days;
+    };
+
+    /** adds the days covered by @p incidence to the occupancy index */
+    void indexIncidence(const KCalendarCore::Incidence::Ptr &incidence);
+
+    /** removes the days previously covered by @p incidence from the occupancy index */
+    void unindexIncidence(const KCalendarCore::Incidence::Ptr &incidence);
+
+    /** returns the kind @p incidence is indexed as, or IncidenceKindCount if
+     *  incidences of its type are not highlighted */
+    IncidenceKind highlightedKind(const KCalendarCore::Incidence::Ptr &incidence) const;
+
+    /** returns the occurrences of the recurring @p incidence within the matrix */
+    KCalendarCore::DateTimeList occurrences(const KCalendarCore::Incidence::Ptr &incidence) const;
+
+    DayMask eventDays(const KCalendarCore::Event::Ptr &event) const;
+    DayMask todoDays(const KCalendarCore::Todo::Ptr &todo) const;
+    DayMask journalDays(const KCalendarCore::Journal::Ptr &journal) const;
+
+    /** returns the days from @p from to @p to (at least @p from), clipped to the matrix */
+    DayMask dayRange(QDate from, QDate to) const;
+
+    /** returns the days with offsets from @p first to @p last, clipped to the matrix */
+    static DayMask offsetRange(qint64 first, qint64 last);
+
+    /** returns the days of the current selection which are visible in the matrix */
+    DayMask selectedDays() const;
+
     /** number of days to be displayed. For now there is no support for any
         other number than 42. so change it at your own risk :o) */
-    static const int NUMDAYS;
+    static constexpr int NUMDAYS = 42;
+    static_assert(NUMDAYS <= 64, "DayMask cannot hold more than 64 days");
 
     /** calendar instance to be queried for holidays, events, ... */
     Akonadi::ETMCalendar::Ptr mCalendar;
 
+    /** shared recurrence expansions, not owned */
+    OccurrenceCache *mOccurrenceCache = nullptr;
+
     /** starting date of the matrix */
     QDate mStartDate;
 
@@ -276,14 +335,33 @@ private:
         subsequently calling QDate::addDays(). */
     QDate *mDays = nullptr;
 
-    /** List for storing days which should be drawn using bold font. */
-    QList<QDate> mEvents;
+    /** number of highlighted incidences of each kind on each day of the matrix,
+        indexed by kind and offset. */
+    int mOccupancy[IncidenceKindCount][NUMDAYS] = {};
+
+    /** days with a non-zero occupancy for each kind. These days are drawn
+        using bold font. */
+    DayMask mIncidenceDays[IncidenceKindCount] = {};
+
+    /** kind and days each indexed incidence contributes to mOccupancy,
+        keyed by the incidence's instance identifier. */
+    QHash<QString, IndexEntry> mIndexedIncidences;
+
+    /** filter of the calendar when the occupancy index was built. Setting
+        another filter doesn't notify the calendar observers. */
+    const KCalendarCore::CalFilter *mFilter = nullptr;
+
+    /** days which are no work days and drawn using the holiday color. */
+    DayMask mHolidayDays = 0;
+
+    /** days not belonging to the displayed month and drawn shaded. */
+    DayMask mShadedDays = 0;
 
     /** stores holiday names of the days shown in the matrix. */
     QMap<int, QString> mHolidays;
 
     /** index of today or -1 if today is not visible in the matrix. */
-    int mToday;
+    int mToday = -1;
 
     /** index of day where dragged selection was initiated.
         used to detect "negative" timely selections */
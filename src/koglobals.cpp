@@ -13,6 +13,8 @@
 
 #include <QApplication>
 
+#include <algorithm>
+
 class KOGlobalsSingletonPrivate
 {
 public:
@@ -42,25 +44,57 @@ QMap<QDate, QStringList> KOGlobals::holiday(const QDate &start, const QDate &end
 {
     QMap<QDate, QStringList> holidaysByDate;
 
-    if (mHolidayRegions.isEmpty()) {
+    if (mHolidayRegions.isEmpty() || !start.isValid() || !end.isValid()) {
         return holidaysByDate;
     }
 
+    for (int year = start.year(); year <= end.year(); ++year) {
+        const HolidayTable table = holidayTable(year);
+        auto it = std::lower_bound(table.cbegin(), table.cend(), start, [](const HolidayEntry &entry, const QDate &date) {
+            return entry.date < date;
+        });
+        for (; it != table.cend() && it->date <= end; ++it) {
+            holidaysByDate.insert(it->date, it->names);
+        }
+    }
+
+    return holidaysByDate;
+}
+
+KOGlobals::HolidayTable KOGlobals::holidayTable(int year) const
+{
+    const auto it = mHolidayTables.constFind(year);
+    if (it != mHolidayTables.constEnd()) {
+        return it.value();
+    }
+
+    const QDate firstDay(year, 1, 1);
+    const QDate lastDay(year, 12, 31);
+    QMap<QDate, QStringList> holidaysByDate;
     for (const KHolidays::HolidayRegion *region : std::as_const(mHolidayRegions)) {
         if (region && region->isValid()) {
-            const KHolidays::Holiday::List list = region->holidays(start, end);
-            const int listCount(list.count());
-            for (int i = 0; i < listCount; ++i) {
-                const KHolidays::Holiday &h = list.at(i);
+            const KHolidays::Holiday::List list = region->holidays(firstDay, lastDay);
+            for (const KHolidays::Holiday &h : list) {
+                // holidays overlapping the year boundary belong to the table of the year they are observed in
+                if (h.observedStartDate().year() != year) {
+                    continue;
+                }
                 // dedupe, since we support multiple holiday regions which may have similar holidays
-                if (!holidaysByDate[h.observedStartDate()].contains(h.name())) {
-                    holidaysByDate[h.observedStartDate()].append(h.name());
+                QStringList &names = holidaysByDate[h.observedStartDate()];
+                if (!names.contains(h.name())) {
+                    names.append(h.name());
                 }
             }
         }
     }
 
-    return holidaysByDate;
+    HolidayTable table;
+    table.reserve(holidaysByDate.size());
+    for (auto i = holidaysByDate.cbegin(), end = holidaysByDate.cend(); i != end; ++i) {
+        table.append({i.key(), i.value()});
+    }
+    mHolidayTables.insert(year, table);
+    return table;
 }
 
 int KOGlobals::firstDayOfWeek() const
@@ -75,8 +109,15 @@ int KOGlobals::getWorkWeekMask()
 
 void KOGlobals::setHolidays(const QStringList &regions)
 {
+    // keep the regions and the computed holidays if nothing changed
+    if (regions == mHolidayRegionNames && !mHolidayRegions.isEmpty()) {
+        return;
+    }
+    mHolidayRegionNames = regions;
+
     qDeleteAll(mHolidayRegions);
     mHolidayRegions.clear();
+    mHolidayTables.clear();
     for (const QString &regionStr : regions) {
         auto region = new KHolidays::HolidayRegion(regionStr);
         if (region->isValid()) {
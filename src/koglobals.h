@@ -11,9 +11,11 @@
 #include "korganizerprivate_export.h"
 
 #include <QDate>
+#include <QHash>
 #include <QList>
 #include <QMap>
 #include <QString>
+#include <QVector>
 
 namespace KHolidays
 {
@@ -31,6 +33,11 @@ public:
 
     ~KOGlobals();
 
+    /**
+       Returns the names of the holidays observed from @p start to @p end,
+       keyed by date. The holidays of each year are computed once for all
+       holiday regions and cached until setHolidays() is called again.
+    */
     Q_REQUIRED_RESULT QMap<QDate, QStringList> holiday(const QDate &start, const QDate &end) const;
 
     Q_REQUIRED_RESULT int firstDayOfWeek() const;
@@ -51,6 +58,19 @@ protected:
     KOGlobals();
 
 private:
+    struct HolidayEntry {
+        QDate date;
+        QStringList names;
+    };
+    /** holidays of one year of all regions, sorted by date */
+    using HolidayTable = QVector<HolidayEntry>;
+
+    HolidayTable holidayTable(int year) const;
+
     QList<KHolidays::HolidayRegion *> mHolidayRegions;
+    QStringList mHolidayRegionNames;
+
+    /** lazily computed holiday tables, keyed by year */
+    mutable QHash<int, HolidayTable> mHolidayTables;
 };
 
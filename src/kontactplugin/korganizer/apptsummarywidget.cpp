@@ -8,9 +8,11 @@
 */
 
 #include "apptsummarywidget.h"
+#include "eventrangeindex.h"
 #include "korganizerinterface.h"
 #include "korganizerplugin.h"
 #include "summaryeventinfo.h"
+#include "summaryrefreshscheduler.h"
 
 #include <CalendarSupport/CalendarSingleton>
 #include <CalendarSupport/Utils>
@@ -52,10 +54,13 @@ ApptSummaryWidget::ApptSummaryWidget(KOrganizerPlugin *plugin, QWidget *parent)
     mLayout->setRowStretch(6, 1);
 
     mCalendar = CalendarSupport::calendarSingleton();
+    mEventIndex = std::make_unique<EventRangeIndex>(mCalendar);
 
     mChanger = new Akonadi::IncidenceChanger(parent);
 
-    connect(mCalendar.data(), &Akonadi::ETMCalendar::calendarChanged, this, &ApptSummaryWidget::updateView);
+    mRefreshScheduler = new SummaryRefreshScheduler(this);
+    connect(mRefreshScheduler, &SummaryRefreshScheduler::refresh, this, &ApptSummaryWidget::updateView);
+    connect(mCalendar.data(), &Akonadi::ETMCalendar::calendarChanged, mRefreshScheduler, &SummaryRefreshScheduler::schedule);
     connect(mPlugin->core(), &KontactInterface::Core::dayChanged, this, &ApptSummaryWidget::updateView);
 
     // Update Configuration
@@ -78,13 +83,15 @@ void ApptSummaryWidget::configUpdated()
     group = config.group("Groupware");
     mShowMineOnly = group.readEntry("ShowMineOnly", false);
 
+    group = config.group("Refresh");
+    mRefreshScheduler->setDelay(group.readEntry("Delay", mRefreshScheduler->delay()));
+
     updateView();
 }
 
 void ApptSummaryWidget::updateView()
 {
-    qDeleteAll(mLabels);
-    mLabels.clear();
+    mRefreshScheduler->cancel();
 
     // The event print consists of the following fields:
     //  icon:start date:days-to-go:summary:time range
@@ -94,6 +101,9 @@ void ApptSummaryWidget::updateView()
     //   the days-to-go is the #days until the event starts
     //   the summary is the event summary
     //   the time range is the start-end time (only for non-floating events)
+    //
+    // The labels of the previous update are reused row by row, so only the
+    // rows which actually changed are touched.
 
     int counter = 0;
 
@@ -105,23 +115,24 @@ void ApptSummaryWidget::updateView()
     SummaryEventInfo::setShowSpecialEvents(mShowBirthdaysFromCal, mShowAnniversariesFromCal);
     QDate currentDate = QDate::currentDate();
 
-    const SummaryEventInfo::List events = SummaryEventInfo::eventsForRange(currentDate, currentDate.addDays(mDaysAhead - 1), mCalendar);
+    const SummaryEventInfo::List events =
+        SummaryEventInfo::eventsForRange(currentDate, currentDate.addDays(mDaysAhead - 1), mCalendar, mEventIndex.get(), &mFormatCache);
 
     QPalette todayPalette = palette();
     KColorScheme::adjustBackground(todayPalette, KColorScheme::ActiveBackground, QPalette::Window);
     QPalette urgentPalette = palette();
     KColorScheme::adjustBackground(urgentPalette, KColorScheme::NegativeBackground, QPalette::Window);
 
-    for (SummaryEventInfo *event : events) {
+    for (const SummaryEventInfo &event : events) {
         // Optionally, show only my Events
         /*      if ( mShowMineOnly &&
-                  !KCalendarCore::CalHelper::isMyCalendarIncidence( mCalendarAdaptor, event->ev ) ) {
+                  !KCalendarCore::CalHelper::isMyCalendarIncidence( mCalendarAdaptor, event.ev ) ) {
               continue;
             }
             TODO: CalHelper is deprecated, remove this?
         */
 
-        KCalendarCore::Event::Ptr ev = event->ev;
+        KCalendarCore::Event::Ptr ev = event.ev;
         // print the first of the recurring event series only
         if (ev->recurs()) {
             if (uidList.contains(ev->instanceIdentifier())) {
@@ -130,89 +141,120 @@ void ApptSummaryWidget::updateView()
             uidList.append(ev->instanceIdentifier());
         }
 
+        if (counter == mRows.count()) {
+            mRows.append(createRow(counter));
+        }
+        EventRow &row = mRows[counter];
+
         // Icon label
-        auto label = new QLabel(this);
+        const QPixmap *icon = &pm;
         if (ev->categories().contains(QLatin1String("BIRTHDAY"), Qt::CaseInsensitive)) {
-            label->setPixmap(pmb);
+            icon = &pmb;
         } else if (ev->categories().contains(QLatin1String("ANNIVERSARY"), Qt::CaseInsensitive)) {
-            label->setPixmap(pma);
-        } else {
-            label->setPixmap(pm);
+            icon = &pma;
+        }
+        if (row.iconKey != icon->cacheKey()) {
+            row.iconKey = icon->cacheKey();
+            row.icon->setPixmap(*icon);
+            row.icon->setMaximumWidth(row.icon->minimumSizeHint().width());
         }
-        label->setMaximumWidth(label->minimumSizeHint().width());
-        mLayout->addWidget(label, counter, 0);
-        mLabels.append(label);
 
         // Start date or date span label
-        QString dateToDisplay = event->startDate;
-        if (!event->dateSpan.isEmpty()) {
-            dateToDisplay = event->dateSpan;
+        QString dateToDisplay = event.startDate;
+        if (!event.dateSpan.isEmpty()) {
+            dateToDisplay = event.dateSpan;
         }
-        label = new QLabel(dateToDisplay, this);
-        label->setAlignment(Qt::AlignLeft | Qt::AlignVCenter);
-        mLayout->addWidget(label, counter, 1);
-        mLabels.append(label);
-        if (event->makeBold) {
-            QFont font = label->font();
-            font.setBold(true);
-            label->setFont(font);
-            if (!event->makeUrgent) {
-                label->setPalette(todayPalette);
-            } else {
-                label->setPalette(urgentPalette);
-            }
-            label->setAutoFillBackground(true);
+        row.date->setText(dateToDisplay);
+        if (row.date->font().bold() != event.makeBold) {
+            QFont font = row.date->font();
+            font.setBold(event.makeBold);
+            row.date->setFont(font);
+        }
+        if (event.makeBold) {
+            row.date->setPalette(event.makeUrgent ? urgentPalette : todayPalette);
+        } else {
+            row.date->setPalette(palette());
         }
+        row.date->setAutoFillBackground(event.makeBold);
 
         // Days to go label
-        label = new QLabel(event->daysToGo, this);
-        label->setAlignment(Qt::AlignLeft | Qt::AlignVCenter);
-        mLayout->addWidget(label, counter, 2);
-        mLabels.append(label);
+        row.daysToGo->setText(event.daysToGo);
 
         // Summary label
-        auto urlLabel = new KUrlLabel(this);
-        urlLabel->setText(event->summaryText);
-        urlLabel->setUrl(event->summaryUrl);
-        urlLabel->installEventFilter(this);
-        urlLabel->setTextFormat(Qt::RichText);
-        urlLabel->setWordWrap(true);
-        mLayout->addWidget(urlLabel, counter, 3);
-        mLabels.append(urlLabel);
-        connect(urlLabel, &KUrlLabel::leftClickedUrl, this, [this, urlLabel] {
-            viewEvent(urlLabel->url());
-        });
-        connect(urlLabel, &KUrlLabel::rightClickedUrl, this, [this, urlLabel] {
-            popupMenu(urlLabel->url());
-        });
-        if (!event->summaryTooltip.isEmpty()) {
-            urlLabel->setToolTip(event->summaryTooltip);
-        }
+        row.summary->setText(event.summaryText);
+        row.summary->setUrl(event.summaryUrl);
+        row.summary->setToolTip(event.summaryTooltip);
 
         // Time range label (only for non-floating events)
-        if (!event->timeRange.isEmpty()) {
-            label = new QLabel(event->timeRange, this);
-            label->setAlignment(Qt::AlignLeft | Qt::AlignVCenter);
-            mLayout->addWidget(label, counter, 4);
-            mLabels.append(label);
-        }
+        row.timeRange->setText(event.timeRange);
+        row.timeRange->setVisible(!event.timeRange.isEmpty());
 
         counter++;
     }
 
-    qDeleteAll(events);
+    // drop the rows of events which are gone
+    while (mRows.count() > counter) {
+        const EventRow row = mRows.takeLast();
+        delete row.icon;
+        delete row.date;
+        delete row.daysToGo;
+        delete row.summary;
+        delete row.timeRange;
+    }
 
     if (!counter) {
-        auto noEvents =
-            new QLabel(i18np("No upcoming events starting within the next day", "No upcoming events starting within the next %1 days", mDaysAhead), this);
-        noEvents->setAlignment(Qt::AlignHCenter | Qt::AlignVCenter);
-        mLayout->addWidget(noEvents, 0, 0);
-        mLabels.append(noEvents);
+        if (!mNoEventsLabel) {
+            mNoEventsLabel = new QLabel(this);
+            mNoEventsLabel->setAlignment(Qt::AlignHCenter | Qt::AlignVCenter);
+            mLayout->addWidget(mNoEventsLabel, 0, 0);
+            mNoEventsLabel->show();
+        }
+        mNoEventsLabel->setText(
+            i18np("No upcoming events starting within the next day", "No upcoming events starting within the next %1 days", mDaysAhead));
+    } else {
+        delete mNoEventsLabel;
+        mNoEventsLabel = nullptr;
     }
+}
 
-    for (QLabel *label : std::as_const(mLabels)) {
-        label->show();
-    }
+ApptSummaryWidget::EventRow ApptSummaryWidget::createRow(int rowIndex)
+{
+    EventRow row;
+
+    row.icon = new QLabel(this);
+    mLayout->addWidget(row.icon, rowIndex, 0);
+
+    row.date = new QLabel(this);
+    row.date->setAlignment(Qt::AlignLeft | Qt::AlignVCenter);
+    mLayout->addWidget(row.date, rowIndex, 1);
+
+    row.daysToGo = new QLabel(this);
+    row.daysToGo->setAlignment(Qt::AlignLeft | Qt::AlignVCenter);
+    mLayout->addWidget(row.daysToGo, rowIndex, 2);
+
+    // the url is read when clicked, so the connections stay valid while the row is reused
+    auto urlLabel = new KUrlLabel(this);
+    urlLabel->installEventFilter(this);
+    urlLabel->setTextFormat(Qt::RichText);
+    urlLabel->setWordWrap(true);
+    mLayout->addWidget(urlLabel, rowIndex, 3);
+    connect(urlLabel, &KUrlLabel::leftClickedUrl, this, [this, urlLabel] {
+        viewEvent(urlLabel->url());
+    });
+    connect(urlLabel, &KUrlLabel::rightClickedUrl, this, [this, urlLabel] {
+        popupMenu(urlLabel->url());
+    });
+    row.summary = urlLabel;
+
+    row.timeRange = new QLabel(this);
+    row.timeRange->setAlignment(Qt::AlignLeft | Qt::AlignVCenter);
+    mLayout->addWidget(row.timeRange, rowIndex, 4);
+
+    row.icon->show();
+    row.date->show();
+    row.daysToGo->show();
+    row.summary->show();
+    return row;
 }
 
 void ApptSummaryWidget::viewEvent(const QString &uid)
@@ -9,10 +9,16 @@
 
 #pragma once
 
+#include "summaryeventinfo.h"
+
 #include <Akonadi/Calendar/ETMCalendar>
 #include <KontactInterface/Summary>
 
+#include <memory>
+
+class EventRangeIndex;
 class KOrganizerPlugin;
+class SummaryRefreshScheduler;
 
 namespace Akonadi
 {
@@ -20,6 +26,7 @@ class Item;
 class IncidenceChanger;
 }
 
+class KUrlLabel;
 class QGridLayout;
 class QLabel;
 
@@ -53,11 +60,27 @@ private Q_SLOTS:
     void removeEvent(const Akonadi::Item &item);
 
 private:
+    /** The labels showing one event. */
+    struct EventRow {
+        QLabel *icon = nullptr;
+        qint64 iconKey = 0; // cache key of the pixmap shown by icon
+        QLabel *date = nullptr;
+        QLabel *daysToGo = nullptr;
+        KUrlLabel *summary = nullptr;
+        QLabel *timeRange = nullptr;
+    };
+
+    Q_REQUIRED_RESULT EventRow createRow(int rowIndex);
+
     Akonadi::ETMCalendar::Ptr mCalendar;
+    std::unique_ptr<EventRangeIndex> mEventIndex;
+    SummaryEventFormatCache mFormatCache;
     Akonadi::IncidenceChanger *mChanger = nullptr;
+    SummaryRefreshScheduler *mRefreshScheduler = nullptr;
 
     QGridLayout *mLayout = nullptr;
-    QList<QLabel *> mLabels;
+    QVector<EventRow> mRows;
+    QLabel *mNoEventsLabel = nullptr;
     KOrganizerPlugin *mPlugin = nullptr;
     int mDaysAhead;
     bool mShowBirthdaysFromCal = false;
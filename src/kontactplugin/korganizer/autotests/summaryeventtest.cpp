@@ -34,17 +34,15 @@ void SummaryEventTester::test_Multiday()
     QVERIFY(cal->addEvent(event));
     for (int i = 0; i < 5; ++i) {
         SummaryEventInfo::List events4 = SummaryEventInfo::eventsForDate(today.addDays(i), cal);
-        QCOMPARE(2, events4.size());
-        SummaryEventInfo *ev4 = events4.at(1);
+        QCOMPARE(static_cast<int>(events4.size()), 2);
+        const SummaryEventInfo &ev4 = events4.at(1);
 
-        QCOMPARE(ev4->summaryText, QString(multidayWithTimeInProgress + QString::fromLatin1(" (%1/7)").arg(i + 2)));
-        QCOMPARE(ev4->timeRange,
+        QCOMPARE(ev4.summaryText, QString(multidayWithTimeInProgress + QString::fromLatin1(" (%1/7)").arg(i + 2)));
+        QCOMPARE(ev4.timeRange,
                  QStringLiteral("%1 - %2").arg(QLocale::system().toString(QTime(0, 0), QLocale::ShortFormat),
                                                QLocale::system().toString(QTime(23, 59), QLocale::ShortFormat)));
-        // QCOMPARE( ev4->startDate, KLocale::global()->formatDate( QDate( today.addDays( i ) ), KLocale::FancyLongDate ) );
-        QCOMPARE(ev4->makeBold, i == 0);
-
-        qDeleteAll(events4);
+        // QCOMPARE( ev4.startDate, KLocale::global()->formatDate( QDate( today.addDays( i ) ), KLocale::FancyLongDate ) );
+        QCOMPARE(ev4.makeBold, i == 0);
     }
 
     // Test date a multiday event in the future has to correct DaysTo set
@@ -56,16 +54,14 @@ void SummaryEventTester::test_Multiday()
     QVERIFY(cal->addEvent(event));
     for (int i = 100; i <= 106; ++i) {
         SummaryEventInfo::List events5 = SummaryEventInfo::eventsForDate(today.addDays(i), cal);
-        QCOMPARE(1, events5.size());
-        SummaryEventInfo *ev5 = events5.at(0);
-        /*qDebug() << ev5->summaryText;
-        qDebug() << ev5->daysToGo;
+        QCOMPARE(static_cast<int>(events5.size()), 1);
+        const SummaryEventInfo &ev5 = events5.at(0);
+        /*qDebug() << ev5.summaryText;
+        qDebug() << ev5.daysToGo;
         qDebug() << i;*/
 
-        QCOMPARE(ev5->summaryText, QString(multiDayWithTimeFuture + QString::fromLatin1(" (%1/7)").arg(i - 100 + 1)));
-        QCOMPARE(ev5->daysToGo, QStringLiteral("in %1 days").arg(i));
-
-        qDeleteAll(events5);
+        QCOMPARE(ev5.summaryText, QString(multiDayWithTimeFuture + QString::fromLatin1(" (%1/7)").arg(i - 100 + 1)));
+        QCOMPARE(ev5.daysToGo, QStringLiteral("in %1 days").arg(i));
     }
 
     QString multiDayAllDayInFuture = QStringLiteral("Multiday, allday, in future");
@@ -98,50 +94,46 @@ void SummaryEventTester::test_Multiday()
     QVERIFY(cal->addEvent(event));
 
     const SummaryEventInfo::List eventsToday = SummaryEventInfo::eventsForDate(today, cal);
-    QCOMPARE(3, eventsToday.size());
-    for (const SummaryEventInfo *ev : eventsToday) {
-        if (ev->summaryText == multidayWithTimeInProgress + QLatin1String(" (2/7)")) {
-            QCOMPARE(ev->timeRange,
+    QCOMPARE(static_cast<int>(eventsToday.size()), 3);
+    for (const SummaryEventInfo &ev : eventsToday) {
+        if (ev.summaryText == multidayWithTimeInProgress + QLatin1String(" (2/7)")) {
+            QCOMPARE(ev.timeRange,
                      QStringLiteral("%1 - %2").arg(QLocale::system().toString(QTime(0, 0), QLocale::ShortFormat),
                                                    QLocale::system().toString(QTime(23, 59), QLocale::ShortFormat)));
-            QCOMPARE(ev->startDate, QStringLiteral("Today"));
-            QCOMPARE(ev->daysToGo, QStringLiteral("now"));
-            QCOMPARE(ev->makeBold, true);
-        } else if (ev->summaryText == multiDayAllDayStartingToday) {
-            QVERIFY(ev->timeRange.isEmpty());
-            QCOMPARE(ev->startDate, QStringLiteral("Today"));
-            QCOMPARE(ev->daysToGo, QStringLiteral("all day"));
-            QCOMPARE(ev->makeBold, true);
-        } else if (ev->summaryText == multiDayAllDayStartingYesterday) {
-            QVERIFY(ev->timeRange.isEmpty());
-            QCOMPARE(ev->startDate, QStringLiteral("Today"));
-            QCOMPARE(ev->daysToGo, QStringLiteral("all day"));
-            QCOMPARE(ev->makeBold, true);
+            QCOMPARE(ev.startDate, QStringLiteral("Today"));
+            QCOMPARE(ev.daysToGo, QStringLiteral("now"));
+            QCOMPARE(ev.makeBold, true);
+        } else if (ev.summaryText == multiDayAllDayStartingToday) {
+            QVERIFY(ev.timeRange.isEmpty());
+            QCOMPARE(ev.startDate, QStringLiteral("Today"));
+            QCOMPARE(ev.daysToGo, QStringLiteral("all day"));
+            QCOMPARE(ev.makeBold, true);
+        } else if (ev.summaryText == multiDayAllDayStartingYesterday) {
+            QVERIFY(ev.timeRange.isEmpty());
+            QCOMPARE(ev.startDate, QStringLiteral("Today"));
+            QCOMPARE(ev.daysToGo, QStringLiteral("all day"));
+            QCOMPARE(ev.makeBold, true);
         } else {
-            qDebug() << "Unexpected " << ev->summaryText << ev->startDate << ev->timeRange << ev->daysToGo;
+            qDebug() << "Unexpected " << ev.summaryText << ev.startDate << ev.timeRange << ev.daysToGo;
             QVERIFY(false); // unexpected event!
         }
     }
 
     SummaryEventInfo::List events2 = SummaryEventInfo::eventsForDate(today.addDays(multiDayFuture), cal);
-    QCOMPARE(1, events2.size());
-    SummaryEventInfo *ev1 = events2.at(0);
-    QCOMPARE(ev1->summaryText, multiDayAllDayInFuture);
-    QVERIFY(ev1->timeRange.isEmpty());
-    QCOMPARE(ev1->startDate, QLocale::system().toString(today.addDays(multiDayFuture)));
-    QCOMPARE(ev1->daysToGo, QString::fromLatin1("in %1 days").arg(multiDayFuture));
-    QCOMPARE(ev1->makeBold, false);
+    QCOMPARE(static_cast<int>(events2.size()), 1);
+    const SummaryEventInfo &ev1 = events2.at(0);
+    QCOMPARE(ev1.summaryText, multiDayAllDayInFuture);
+    QVERIFY(ev1.timeRange.isEmpty());
+    QCOMPARE(ev1.startDate, QLocale::system().toString(today.addDays(multiDayFuture)));
+    QCOMPARE(ev1.daysToGo, QString::fromLatin1("in %1 days").arg(multiDayFuture));
+    QCOMPARE(ev1.makeBold, false);
     // Make sure multiday is only displayed once
     for (int i = 1; i < 30; ++i) {
         const SummaryEventInfo::List events3 = SummaryEventInfo::eventsForDate(today.addDays(multiDayFuture + i), cal);
-        for (SummaryEventInfo *ev : events3) {
-            QVERIFY(ev->summaryText.contains(multiDayAllDayInFuture));
+        for (const SummaryEventInfo &ev : events3) {
+            QVERIFY(ev.summaryText.contains(multiDayAllDayInFuture));
         }
-        qDeleteAll(events3);
     }
-
-    qDeleteAll(eventsToday);
-    qDeleteAll(events2);
 }
 
 void SummaryEventTester::test_eventsForRange_data()
@@ -175,7 +167,5 @@ void SummaryEventTester::test_eventsForRange()
     QVERIFY(cal->addEvent(event));
 
     SummaryEventInfo::List events = SummaryEventInfo::eventsForRange(today, today.addDays(7), cal);
-    QCOMPARE(events.count() == 1, inside);
-
-    qDeleteAll(events);
+    QCOMPARE(events.size() == 1, inside);
 }
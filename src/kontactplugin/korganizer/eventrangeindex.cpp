@@ -0,0 +1,131 @@
+/*
+  This file is part of Kontact.
+
+  SPDX-FileCopyrightText: 2026 KOrganizer Developers
+
+  SPDX-License-Identifier: GPL-2.0-or-later WITH Qt-Commercial-exception-1.0
+*/
+
+#include "eventrangeindex.h"
+
+#include <KCalendarCore/CalFilter>
+
+#include <algorithm>
+
+using namespace KCalendarCore;
+
+EventRangeIndex::EventRangeIndex(const Akonadi::ETMCalendar::Ptr &calendar)
+    : mCalendar(calendar)
+{
+    mCalendar->registerObserver(this);
+}
+
+EventRangeIndex::~EventRangeIndex()
+{
+    mCalendar->unregisterObserver(this);
+}
+
+Event::List EventRangeIndex::events(QDate start, QDate end)
+{
+    if (mDirty) {
+        rebuild();
+    }
+
+    Event::List events;
+
+    // a non-recurring event overlapping the range starts at most mMaxSpan days before it
+    const auto last = mEvents.cend();
+    for (auto it = std::as_const(mEvents).lowerBound(start.addDays(-mMaxSpan)); it != last && it.key() <= end; ++it) {
+        if (it.value()->dtEnd().toLocalTime().date() >= start) {
+            events.append(it.value());
+        }
+    }
+
+    const auto lastRecurring = mRecurringEvents.cend();
+    for (auto it = mRecurringEvents.cbegin(); it != lastRecurring && it.key() <= end; ++it) {
+        // an invalid end date means the recurrence never ends
+        const QDate recurrenceEnd = it.value()->recurrence()->endDate();
+        if (!recurrenceEnd.isValid() || recurrenceEnd >= start) {
+            events.append(it.value());
+        }
+    }
+
+    const CalFilter *filter = mCalendar->filter();
+    if (filter && filter->isEnabled()) {
+        events.erase(std::remove_if(events.begin(),
+                                    events.end(),
+                                    [filter](const Event::Ptr &event) {
+                                        return !filter->filterIncidence(event);
+                                    }),
+                     events.end());
+    }
+
+    return events;
+}
+
+void EventRangeIndex::rebuild()
+{
+    mEvents.clear();
+    mRecurringEvents.clear();
+    mEntries.clear();
+    mMaxSpan = 0;
+    mDirty = false;
+
+    const Event::List events = mCalendar->rawEvents();
+    for (const Event::Ptr &event : events) {
+        insert(event);
+    }
+}
+
+void EventRangeIndex::insert(const Event::Ptr &event)
+{
+    const QDate start = event->dtStart().toLocalTime().date();
+    const bool recurs = event->recurs();
+    if (recurs) {
+        mRecurringEvents.insert(start, event);
+    } else {
+        mEvents.insert(start, event);
+        mMaxSpan = qMax(mMaxSpan, start.daysTo(event->dtEnd().toLocalTime().date()));
+    }
+    mEntries.insert(event->instanceIdentifier(), {start, recurs});
+}
+
+void EventRangeIndex::remove(const QString &instanceIdentifier)
+{
+    const auto entry = mEntries.find(instanceIdentifier);
+    if (entry == mEntries.end()) {
+        return;
+    }
+
+    QMultiMap<QDate, Event::Ptr> &map = entry->recurs ? mRecurringEvents : mEvents;
+    for (auto it = map.find(entry->start); it != map.end() && it.key() == entry->start; ++it) {
+        if (it.value()->instanceIdentifier() == instanceIdentifier) {
+            map.erase(it);
+            break;
+        }
+    }
+    mEntries.erase(entry);
+}
+
+void EventRangeIndex::calendarIncidenceAdded(const Incidence::Ptr &incidence)
+{
+    calendarIncidenceChanged(incidence);
+}
+
+void EventRangeIndex::calendarIncidenceChanged(const Incidence::Ptr &incidence)
+{
+    // while dirty, the next lookup indexes everything anyway
+    if (mDirty || incidence->type() != Incidence::TypeEvent) {
+        return;
+    }
+    remove(incidence->instanceIdentifier());
+    insert(incidence.staticCast<Event>());
+}
+
+void EventRangeIndex::calendarIncidenceDeleted(const Incidence::Ptr &incidence, const Calendar *calendar)
+{
+    Q_UNUSED(calendar)
+    if (!mDirty) {
+        remove(incidence->instanceIdentifier());
+    }
+}
@@ -0,0 +1,66 @@
+/*
+  This file is part of Kontact.
+
+  SPDX-FileCopyrightText: 2026 KOrganizer Developers
+
+  SPDX-License-Identifier: GPL-2.0-or-later WITH Qt-Commercial-exception-1.0
+*/
+#pragma once
+
+#include <Akonadi/Calendar/ETMCalendar>
+
+#include <QDate>
+#include <QHash>
+#include <QMultiMap>
+
+/**
+ * Indexes the events of a calendar by date, so that the events which may
+ * occur in a range of days can be found without visiting the whole calendar.
+ *
+ * Non-recurring events are kept sorted by their start date, together with
+ * the longest event span. Recurring events are kept sorted by their start
+ * date as well, and are skipped once their recurrence has ended before the
+ * range.
+ *
+ * The index is built on the first lookup and then kept up to date through
+ * the calendar observer interface.
+ */
+class EventRangeIndex : public Akonadi::ETMCalendar::CalendarObserver
+{
+public:
+    explicit EventRangeIndex(const Akonadi::ETMCalendar::Ptr &calendar);
+    ~EventRangeIndex() override;
+
+    /**
+      Returns the events which may occur between @p start and @p end, inclusive.
+      The calendar's filter is applied, but callers still have to check the
+      occurrences of the returned events.
+    */
+    Q_REQUIRED_RESULT KCalendarCore::Event::List events(QDate start, QDate end);
+
+    void calendarIncidenceAdded(const KCalendarCore::Incidence::Ptr &incidence) override;
+    void calendarIncidenceChanged(const KCalendarCore::Incidence::Ptr &incidence) override;
+    void calendarIncidenceDeleted(const KCalendarCore::Incidence::Ptr &incidence, const KCalendarCore::Calendar *calendar) override;
+
+private:
+    struct Entry {
+        QDate start;
+        bool recurs;
+    };
+
+    void rebuild();
+    void insert(const KCalendarCore::Event::Ptr &event);
+    void remove(const QString &instanceIdentifier);
+
+    Akonadi::ETMCalendar::Ptr mCalendar;
+
+    /** non-recurring events, by local start date */
+    QMultiMap<QDate, KCalendarCore::Event::Ptr> mEvents;
+    /** recurring events, by local start date */
+    QMultiMap<QDate, KCalendarCore::Event::Ptr> mRecurringEvents;
+    /** where each event is indexed, keyed by instance identifier */
+    QHash<QString, Entry> mEntries;
+    /** the longest span of a non-recurring event, in days */
+    qint64 mMaxSpan = 0;
+    bool mDirty = true;
+};
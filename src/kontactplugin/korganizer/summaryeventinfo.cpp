@@ -9,6 +9,7 @@
 */
 
 #include "summaryeventinfo.h"
+#include "eventrangeindex.h"
 
 #include <Akonadi/Item>
 
@@ -25,23 +26,26 @@ using namespace KCalUtils;
 #include <QLocale>
 #include <QStringList>
 
+#include <algorithm>
+
 bool SummaryEventInfo::mShowBirthdays = true;
 bool SummaryEventInfo::mShowAnniversaries = true;
 
-using DateTimeByUidHash = QHash<QString, QDateTime>;
-Q_GLOBAL_STATIC(DateTimeByUidHash, sDateTimeByUid)
+namespace
+{
+/** An event in the range, with the start of its first occurrence there. */
+struct Occurrence {
+    KCalendarCore::Event::Ptr event;
+    QDateTime start;
+};
 
-static bool eventLessThan(const KCalendarCore::Event::Ptr &event1, const KCalendarCore::Event::Ptr &event2)
+bool occurrenceLessThan(const Occurrence &occurrence1, const Occurrence &occurrence2)
 {
-    QDateTime kdt1 = sDateTimeByUid()->value(event1->instanceIdentifier());
-    QDateTime kdt2 = sDateTimeByUid()->value(event2->instanceIdentifier());
-    if (kdt1 < kdt2) {
-        return true;
-    } else if (kdt1 > kdt2) {
-        return false;
-    } else {
-        return event1->summary() < event2->summary();
+    if (occurrence1.start != occurrence2.start) {
+        return occurrence1.start < occurrence2.start;
     }
+    return occurrence1.event->summary() < occurrence2.event->summary();
+}
 }
 
 void SummaryEventInfo::setShowSpecialEvents(bool showBirthdays, bool showAnniversaries)
@@ -68,16 +72,18 @@ bool SummaryEventInfo::skip(const KCalendarCore::Event::Ptr &event)
 SummaryEventInfo::SummaryEventInfo() = default;
 
 /**static*/
-SummaryEventInfo::List SummaryEventInfo::eventsForRange(QDate start, QDate end, const Akonadi::ETMCalendar::Ptr &calendar)
+SummaryEventInfo::List SummaryEventInfo::eventsForRange(QDate start,
+                                                        QDate end,
+                                                        const Akonadi::ETMCalendar::Ptr &calendar,
+                                                        EventRangeIndex *index,
+                                                        SummaryEventFormatCache *cache)
 {
-    KCalendarCore::Event::List allEvents = calendar->events();
-    KCalendarCore::Event::List events;
+    const KCalendarCore::Event::List allEvents = index ? index->events(start, end) : calendar->events();
+    std::vector<Occurrence> occurrences;
     const auto currentDateTime = QDateTime::currentDateTime();
     const QDate currentDate = currentDateTime.date();
 
-    sDateTimeByUid()->clear();
-    for (int i = 0; i < allEvents.count(); ++i) {
-        KCalendarCore::Event::Ptr event = allEvents.at(i);
+    for (const KCalendarCore::Event::Ptr &event : allEvents) {
         if (skip(event)) {
             continue;
         }
@@ -85,37 +91,36 @@ SummaryEventInfo::List SummaryEventInfo::eventsForRange(QDate start, QDate end,
         const auto eventStart = event->dtStart().toLocalTime();
         const auto eventEnd = event->dtEnd().toLocalTime();
         if (event->recurs()) {
-            const auto occurrences = event->recurrence()->timesInInterval(QDateTime(start, {}), QDateTime(end, {}));
-            if (!occurrences.isEmpty()) {
-                events << event;
-                sDateTimeByUid()->insert(event->instanceIdentifier(), occurrences.first());
+            const auto times = event->recurrence()->timesInInterval(QDateTime(start, {}), QDateTime(end, {}));
+            if (!times.isEmpty()) {
+                occurrences.push_back({event, times.first()});
             }
         } else {
             if ((end >= eventStart.date() && start <= eventEnd.date()) || (start >= eventStart.date() && end <= eventEnd.date())) {
-                events << event;
                 if (eventStart.date() < start) {
-                    sDateTimeByUid()->insert(event->instanceIdentifier(), QDateTime(start.startOfDay()));
+                    occurrences.push_back({event, QDateTime(start.startOfDay())});
                 } else {
-                    sDateTimeByUid()->insert(event->instanceIdentifier(), eventStart);
+                    occurrences.push_back({event, eventStart});
                 }
             }
         }
     }
 
-    std::sort(events.begin(), events.end(), eventLessThan);
+    std::sort(occurrences.begin(), occurrences.end(), occurrenceLessThan);
+
+    // Entries of events which are not in the range anymore are dropped.
+    QHash<QString, SummaryEventFormatCache::Entry> cacheEntries;
 
     SummaryEventInfo::List eventInfoList;
-    KCalendarCore::Event::Ptr ev;
-    eventInfoList.reserve(events.count());
-    auto itEnd = events.constEnd();
-    for (auto it = events.constBegin(); it != itEnd; ++it) {
-        ev = *it;
+    eventInfoList.reserve(occurrences.size());
+    for (const Occurrence &occurrence : occurrences) {
+        const KCalendarCore::Event::Ptr &ev = occurrence.event;
         // Count number of days remaining in multiday event
         int span = 1;
         int dayof = 1;
         const auto eventStart = ev->dtStart().toLocalTime();
         const auto eventEnd = ev->dtEnd().toLocalTime();
-        const QDate occurrenceStartDate = sDateTimeByUid()->value(ev->instanceIdentifier()).date();
+        const QDate occurrenceStartDate = occurrence.start.date();
 
         QDate startOfMultiday = eventStart.date();
         if (startOfMultiday < currentDate) {
@@ -123,8 +128,8 @@ SummaryEventInfo::List SummaryEventInfo::eventsForRange(QDate start, QDate end,
         }
         bool firstDayOfMultiday = (start == startOfMultiday);
 
-        auto summaryEvent = new SummaryEventInfo();
-        eventInfoList.append(summaryEvent);
+        eventInfoList.emplace_back();
+        SummaryEventInfo *summaryEvent = &eventInfoList.back();
 
         // Event
         summaryEvent->ev = ev;
@@ -204,16 +209,6 @@ SummaryEventInfo::List SummaryEventInfo::eventsForRange(QDate start, QDate end,
             }
         }
         summaryEvent->daysToGo = str;
-
-        // Summary label
-        str = ev->richSummary();
-        if (ev->isMultiDay() && !ev->allDay()) {
-            str.append(QStringLiteral(" (%1/%2)").arg(dayof).arg(span));
-        }
-        summaryEvent->summaryText = str;
-        if (!ev->location().isEmpty()) {
-            summaryEvent->summaryText.append(QStringLiteral(" (%1)").arg(ev->location()));
-        }
         summaryEvent->summaryUrl = ev->uid();
 
         QString displayName;
@@ -224,7 +219,34 @@ SummaryEventInfo::List SummaryEventInfo::eventsForRange(QDate start, QDate end,
                 displayName = col.displayName();
             }
         }
-        summaryEvent->summaryTooltip = KCalUtils::IncidenceFormatter::toolTipStr(displayName, ev, start, true);
+
+        // The summary, tooltip and next occurrence only change with the event
+        // itself, reuse them from the last refresh if possible.
+        const QString identifier = ev->instanceIdentifier();
+        const SummaryEventFormatCache::Entry *cached = nullptr;
+        if (cache) {
+            const auto it = cache->mEntries.constFind(identifier);
+            if (it != cache->mEntries.cend() && it->revision == ev->revision() && it->lastModified == ev->lastModified() && it->rangeStart == start
+                && it->displayName == displayName) {
+                cached = &it.value();
+            }
+        }
+        if (cached) {
+            summaryEvent->summaryText = cached->summaryText;
+            summaryEvent->summaryTooltip = cached->summaryTooltip;
+        } else {
+            // Summary label
+            str = ev->richSummary();
+            if (ev->isMultiDay() && !ev->allDay()) {
+                str.append(QStringLiteral(" (%1/%2)").arg(dayof).arg(span));
+            }
+            summaryEvent->summaryText = str;
+            if (!ev->location().isEmpty()) {
+                summaryEvent->summaryText.append(QStringLiteral(" (%1)").arg(ev->location()));
+            }
+
+            summaryEvent->summaryTooltip = KCalUtils::IncidenceFormatter::toolTipStr(displayName, ev, start, true);
+        }
 
         // Time range label (only for non-floating events)
         str.clear();
@@ -247,16 +269,37 @@ SummaryEventInfo::List SummaryEventInfo::eventsForRange(QDate start, QDate end,
         }
 
         // For recurring events, append the next occurrence to the time range label
+        QString nextOccurrence;
         if (ev->recurs()) {
-            QDateTime kdt(start, QTime(0, 0, 0));
-            kdt = kdt.addSecs(-1);
-            QDateTime next = ev->recurrence()->getNextDateTime(kdt);
-            QString tmp = IncidenceFormatter::dateTimeToString(ev->recurrence()->getNextDateTime(next), ev->allDay(), true);
+            if (cached) {
+                nextOccurrence = cached->nextOccurrence;
+            } else {
+                QDateTime kdt(start, QTime(0, 0, 0));
+                kdt = kdt.addSecs(-1);
+                QDateTime next = ev->recurrence()->getNextDateTime(kdt);
+                QString tmp = IncidenceFormatter::dateTimeToString(ev->recurrence()->getNextDateTime(next), ev->allDay(), true);
+                nextOccurrence = QLatin1String("<font size=\"small\"><i>") + i18nc("next occurrence", "Next: %1", tmp) + QLatin1String("</i></font>");
+            }
             if (!summaryEvent->timeRange.isEmpty()) {
                 summaryEvent->timeRange += QLatin1String("<br>");
             }
-            summaryEvent->timeRange += QLatin1String("<font size=\"small\"><i>") + i18nc("next occurrence", "Next: %1", tmp) + QLatin1String("</i></font>");
+            summaryEvent->timeRange += nextOccurrence;
         }
+
+        if (cache) {
+            SummaryEventFormatCache::Entry &entry = cacheEntries[identifier];
+            entry.revision = ev->revision();
+            entry.lastModified = ev->lastModified();
+            entry.rangeStart = start;
+            entry.displayName = displayName;
+            entry.summaryText = summaryEvent->summaryText;
+            entry.summaryTooltip = summaryEvent->summaryTooltip;
+            entry.nextOccurrence = nextOccurrence;
+        }
+    }
+
+    if (cache) {
+        cache->mEntries = std::move(cacheEntries);
     }
 
     return eventInfoList;
@@ -266,3 +309,7 @@ SummaryEventInfo::List SummaryEventInfo::eventsForDate(QDate date, const Akonadi
 {
     return eventsForRange(date, date, calendar);
 }
+
+SummaryEventFormatCache::SummaryEventFormatCache() = default;
+
+SummaryEventFormatCache::~SummaryEventFormatCache() = default;
@@ -11,19 +11,63 @@
 
 #include <Akonadi/Calendar/ETMCalendar>
 
-class QDate;
+#include <QDate>
+#include <QHash>
+
+#include <vector>
+
+class EventRangeIndex;
+
+/**
+ * Keeps the formatted texts of the events listed by the last
+ * SummaryEventInfo::eventsForRange() call, so that they are only rebuilt
+ * for events which changed in the meantime.
+ */
+class SummaryEventFormatCache
+{
+public:
+    SummaryEventFormatCache();
+    ~SummaryEventFormatCache();
+
+private:
+    friend class SummaryEventInfo;
+
+    struct Entry {
+        // the cached texts are valid for this revision of the event and range start
+        int revision = 0;
+        QDateTime lastModified;
+        QDate rangeStart;
+        QString displayName;
+
+        QString summaryText;
+        QString summaryTooltip;
+        QString nextOccurrence;
+    };
+
+    /** keyed by instance identifier */
+    QHash<QString, Entry> mEntries;
+};
 
 class SummaryEventInfo
 {
 public:
-    using List = QList<SummaryEventInfo *>;
+    using List = std::vector<SummaryEventInfo>;
 
     SummaryEventInfo();
+    SummaryEventInfo(SummaryEventInfo &&) = default;
+    SummaryEventInfo &operator=(SummaryEventInfo &&) = default;
 
     static List eventsForDate(QDate date, const Akonadi::ETMCalendar::Ptr &calendar);
+    /**
+      If @p index is given, only the events it returns for the range are
+      considered, instead of all events of @p calendar. If @p cache is given,
+      texts of unchanged events are taken from it and it is updated.
+    */
     static List eventsForRange(QDate start,
                                QDate end, // range is inclusive
-                               const Akonadi::ETMCalendar::Ptr &calendar);
+                               const Akonadi::ETMCalendar::Ptr &calendar,
+                               EventRangeIndex *index = nullptr,
+                               SummaryEventFormatCache *cache = nullptr);
     static void setShowSpecialEvents(bool skipBirthdays, bool skipAnniversaries);
 
     KCalendarCore::Event::Ptr ev;
@@ -38,7 +82,7 @@ public:
     bool makeUrgent = false;
 
 private:
+    Q_DISABLE_COPY(SummaryEventInfo)
     static bool skip(const KCalendarCore::Event::Ptr &event);
     static bool mShowBirthdays, mShowAnniversaries;
 };
-
@@ -0,0 +1,79 @@
+/*
+  This file is part of Kontact.
+
+  SPDX-FileCopyrightText: 2026 KOrganizer Developers
+
+  SPDX-License-Identifier: GPL-2.0-or-later WITH Qt-Commercial-exception-1.0
+*/
+
+#include "summaryrefreshscheduler.h"
+
+#include <QEvent>
+#include <QWidget>
+
+static const int s_defaultDelay = 500; // ms
+
+// A continuous stream of requests refreshes at least every this many delays
+static const int s_maxDelays = 5;
+
+SummaryRefreshScheduler::SummaryRefreshScheduler(QWidget *summary)
+    : QObject(summary)
+    , mSummary(summary)
+    , mDelay(s_defaultDelay)
+{
+    mTimer.setSingleShot(true);
+    connect(&mTimer, &QTimer::timeout, this, &SummaryRefreshScheduler::slotTimeout);
+    mSummary->installEventFilter(this);
+}
+
+SummaryRefreshScheduler::~SummaryRefreshScheduler() = default;
+
+void SummaryRefreshScheduler::setDelay(int msecs)
+{
+    mDelay = qMax(0, msecs);
+}
+
+int SummaryRefreshScheduler::delay() const
+{
+    return mDelay;
+}
+
+void SummaryRefreshScheduler::schedule()
+{
+    if (!mPending) {
+        mPending = true;
+        mPendingSince.start();
+    }
+
+    if (!mSummary->isVisible()) {
+        // refreshed as soon as the summary is shown again
+        mTimer.stop();
+        return;
+    }
+
+    const qint64 remaining = s_maxDelays * mDelay - mPendingSince.elapsed();
+    mTimer.start(static_cast<int>(qBound<qint64>(0, remaining, mDelay)));
+}
+
+void SummaryRefreshScheduler::cancel()
+{
+    mPending = false;
+    mTimer.stop();
+}
+
+bool SummaryRefreshScheduler::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched == mSummary && event->type() == QEvent::Show && mPending) {
+        mTimer.start(0);
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+void SummaryRefreshScheduler::slotTimeout()
+{
+    if (!mPending || !mSummary->isVisible()) {
+        return;
+    }
+    mPending = false;
+    Q_EMIT refresh();
+}
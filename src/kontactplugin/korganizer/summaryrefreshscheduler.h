@@ -0,0 +1,58 @@
+/*
+  This file is part of Kontact.
+
+  SPDX-FileCopyrightText: 2026 KOrganizer Developers
+
+  SPDX-License-Identifier: GPL-2.0-or-later WITH Qt-Commercial-exception-1.0
+*/
+
+#pragma once
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QTimer>
+
+class QWidget;
+
+/**
+ * Coalesces the refresh requests of a summary widget.
+ *
+ * Syncing a large calendar emits a burst of change notifications. Instead
+ * of rebuilding the summary for each of them, schedule() postpones the
+ * refresh until no request came in for delay() milliseconds, or at most
+ * a few delays after the first one. While the summary is hidden, refreshes
+ * are held back until it is shown again.
+ */
+class SummaryRefreshScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SummaryRefreshScheduler(QWidget *summary);
+    ~SummaryRefreshScheduler() override;
+
+    /** Sets the quiet time after the last request before refreshing, in milliseconds. */
+    void setDelay(int msecs);
+    Q_REQUIRED_RESULT int delay() const;
+
+    /** Requests a refresh, coalesced with other requests. */
+    void schedule();
+
+    /** Drops a pending refresh, to be called when the summary was refreshed. */
+    void cancel();
+
+Q_SIGNALS:
+    void refresh();
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private:
+    void slotTimeout();
+
+    QWidget *const mSummary;
+    QTimer mTimer;
+    QElapsedTimer mPendingSince;
+    int mDelay;
+    bool mPending = false;
+};
@@ -0,0 +1,142 @@
+/*
+  This file is part of Kontact.
+
+  SPDX-FileCopyrightText: 2026 KOrganizer Developers
+
+  SPDX-License-Identifier: GPL-2.0-or-later WITH Qt-Commercial-exception-1.0
+*/
+
+#include "tododueindex.h"
+
+#include <KCalendarCore/CalFilter>
+
+#include <algorithm>
+
+using namespace KCalendarCore;
+
+TodoDueIndex::TodoDueIndex(const Akonadi::ETMCalendar::Ptr &calendar)
+    : mCalendar(calendar)
+{
+    mCalendar->registerObserver(this);
+}
+
+TodoDueIndex::~TodoDueIndex()
+{
+    mCalendar->unregisterObserver(this);
+}
+
+Todo::List TodoDueIndex::todos(QDate limit, bool includeCompleted, bool includeOpenEnded)
+{
+    if (mDirty) {
+        rebuild();
+    }
+
+    Todo::List todos;
+    const auto last = mOpenTodos.cend();
+    for (auto it = mOpenTodos.cbegin(); it != last && it.key() < limit; ++it) {
+        todos.append(it.value());
+    }
+    if (includeCompleted) {
+        const auto lastCompleted = mCompletedTodos.cend();
+        for (auto it = mCompletedTodos.cbegin(); it != lastCompleted && it.key() < limit; ++it) {
+            todos.append(it.value());
+        }
+    }
+    if (includeOpenEnded || includeCompleted) {
+        // completed to-dos without due date don't count as open-ended
+        for (const Todo::Ptr &todo : std::as_const(mOpenEndedTodos)) {
+            if (todo->isCompleted() ? includeCompleted : includeOpenEnded) {
+                todos.append(todo);
+            }
+        }
+    }
+
+    const CalFilter *filter = mCalendar->filter();
+    if (filter && filter->isEnabled()) {
+        todos.erase(std::remove_if(todos.begin(),
+                                   todos.end(),
+                                   [filter](const Todo::Ptr &todo) {
+                                       return !filter->filterIncidence(todo);
+                                   }),
+                    todos.end());
+    }
+
+    return todos;
+}
+
+void TodoDueIndex::rebuild()
+{
+    mOpenTodos.clear();
+    mCompletedTodos.clear();
+    mOpenEndedTodos.clear();
+    mEntries.clear();
+    mDirty = false;
+
+    const Todo::List todos = mCalendar->rawTodos();
+    for (const Todo::Ptr &todo : todos) {
+        insert(todo);
+    }
+}
+
+QMultiMap<QDate, Todo::Ptr> &TodoDueIndex::map(bool completed)
+{
+    return completed ? mCompletedTodos : mOpenTodos;
+}
+
+void TodoDueIndex::insert(const Todo::Ptr &todo)
+{
+    const QString identifier = todo->instanceIdentifier();
+    const bool completed = todo->isCompleted();
+    QDate due;
+    if (todo->hasDueDate() && todo->dtDue().date().isValid()) {
+        due = todo->dtDue().date();
+        map(completed).insert(due, todo);
+    } else {
+        mOpenEndedTodos.insert(identifier, todo);
+    }
+    mEntries.insert(identifier, {due, completed});
+}
+
+void TodoDueIndex::remove(const QString &instanceIdentifier)
+{
+    const auto entry = mEntries.find(instanceIdentifier);
+    if (entry == mEntries.end()) {
+        return;
+    }
+
+    if (entry->due.isValid()) {
+        QMultiMap<QDate, Todo::Ptr> &todos = map(entry->completed);
+        for (auto it = todos.find(entry->due); it != todos.end() && it.key() == entry->due; ++it) {
+            if (it.value()->instanceIdentifier() == instanceIdentifier) {
+                todos.erase(it);
+                break;
+            }
+        }
+    } else {
+        mOpenEndedTodos.remove(instanceIdentifier);
+    }
+    mEntries.erase(entry);
+}
+
+void TodoDueIndex::calendarIncidenceAdded(const Incidence::Ptr &incidence)
+{
+    calendarIncidenceChanged(incidence);
+}
+
+void TodoDueIndex::calendarIncidenceChanged(const Incidence::Ptr &incidence)
+{
+    // while dirty, the next lookup indexes everything anyway
+    if (mDirty || incidence->type() != Incidence::TypeTodo) {
+        return;
+    }
+    remove(incidence->instanceIdentifier());
+    insert(incidence.staticCast<Todo>());
+}
+
+void TodoDueIndex::calendarIncidenceDeleted(const Incidence::Ptr &incidence, const Calendar *calendar)
+{
+    Q_UNUSED(calendar)
+    if (!mDirty) {
+        remove(incidence->instanceIdentifier());
+    }
+}
@@ -0,0 +1,62 @@
+/*
+  This file is part of Kontact.
+
+  SPDX-FileCopyrightText: 2026 KOrganizer Developers
+
+  SPDX-License-Identifier: GPL-2.0-or-later WITH Qt-Commercial-exception-1.0
+*/
+#pragma once
+
+#include <Akonadi/Calendar/ETMCalendar>
+
+#include <QDate>
+#include <QHash>
+#include <QMultiMap>
+
+/**
+ * Indexes the to-dos of a calendar by due date, separating open from
+ * completed ones, so that the to-dos due soon can be listed without
+ * visiting the whole calendar.
+ *
+ * The index is built on the first lookup and then kept up to date through
+ * the calendar observer interface.
+ */
+class TodoDueIndex : public Akonadi::ETMCalendar::CalendarObserver
+{
+public:
+    explicit TodoDueIndex(const Akonadi::ETMCalendar::Ptr &calendar);
+    ~TodoDueIndex() override;
+
+    /**
+      Returns the to-dos due before @p limit, including overdue ones.
+      Completed to-dos and open ones without due date are only returned if asked for.
+      The calendar's filter is applied.
+    */
+    Q_REQUIRED_RESULT KCalendarCore::Todo::List todos(QDate limit, bool includeCompleted, bool includeOpenEnded);
+
+    void calendarIncidenceAdded(const KCalendarCore::Incidence::Ptr &incidence) override;
+    void calendarIncidenceChanged(const KCalendarCore::Incidence::Ptr &incidence) override;
+    void calendarIncidenceDeleted(const KCalendarCore::Incidence::Ptr &incidence, const KCalendarCore::Calendar *calendar) override;
+
+private:
+    struct Entry {
+        QDate due; // invalid for open-ended to-dos
+        bool completed;
+    };
+
+    void rebuild();
+    void insert(const KCalendarCore::Todo::Ptr &todo);
+    void remove(const QString &instanceIdentifier);
+    QMultiMap<QDate, KCalendarCore::Todo::Ptr> &map(bool completed);
+
+    Akonadi::ETMCalendar::Ptr mCalendar;
+
+    /** to-dos with a due date, by due date */
+    QMultiMap<QDate, KCalendarCore::Todo::Ptr> mOpenTodos;
+    QMultiMap<QDate, KCalendarCore::Todo::Ptr> mCompletedTodos;
+    /** to-dos without a due date, keyed by instance identifier */
+    QHash<QString, KCalendarCore::Todo::Ptr> mOpenEndedTodos;
+    /** where each to-do is indexed, keyed by instance identifier */
+    QHash<QString, Entry> mEntries;
+    bool mDirty = true;
+};
@@ -9,6 +9,8 @@
 
 #include "todosummarywidget.h"
 #include "korganizerinterface.h"
+#include "summaryrefreshscheduler.h"
+#include "tododueindex.h"
 #include "todoplugin.h"
 #include <CalendarSupport/CalendarSingleton>
 #include <CalendarSupport/Utils>
@@ -33,8 +35,25 @@
 #include <QTextDocument> // for Qt::mightBeRichText
 #include <QVBoxLayout>
 
+#include <algorithm>
+
 using namespace KCalUtils;
 
+// Sorts by due date, to-dos without one last, then by priority and summary
+static bool todoLessThan(const KCalendarCore::Todo::Ptr &todo1, const KCalendarCore::Todo::Ptr &todo2)
+{
+    if (todo1->hasDueDate() != todo2->hasDueDate()) {
+        return todo1->hasDueDate();
+    }
+    if (todo1->hasDueDate() && todo1->dtDue() != todo2->dtDue()) {
+        return todo1->dtDue() < todo2->dtDue();
+    }
+    if (todo1->priority() != todo2->priority()) {
+        return todo1->priority() < todo2->priority();
+    }
+    return QString::compare(todo1->summary(), todo2->summary(), Qt::CaseInsensitive) < 0;
+}
+
 TodoSummaryWidget::TodoSummaryWidget(TodoPlugin *plugin, QWidget *parent)
     : KontactInterface::Summary(parent)
     , mPlugin(plugin)
@@ -51,25 +70,26 @@ TodoSummaryWidget::TodoSummaryWidget(TodoPlugin *plugin, QWidget *parent)
     mLayout->setSpacing(3);
     mLayout->setRowStretch(6, 1);
     mCalendar = CalendarSupport::calendarSingleton();
+    mTodoIndex = std::make_unique<TodoDueIndex>(mCalendar);
 
     mChanger = new Akonadi::IncidenceChanger(parent);
 
-    connect(mCalendar.data(), &Akonadi::ETMCalendar::calendarChanged, this, &TodoSummaryWidget::updateView);
+    mRefreshScheduler = new SummaryRefreshScheduler(this);
+    connect(mRefreshScheduler, &SummaryRefreshScheduler::refresh, this, &TodoSummaryWidget::updateView);
+    connect(mCalendar.data(), &Akonadi::ETMCalendar::calendarChanged, mRefreshScheduler, &SummaryRefreshScheduler::schedule);
     connect(mPlugin->core(), &KontactInterface::Core::dayChanged, this, &TodoSummaryWidget::updateView);
 
-    updateView();
+    // Update Configuration
+    configUpdated();
 }
 
 TodoSummaryWidget::~TodoSummaryWidget() = default;
 
-void TodoSummaryWidget::updateView()
+void TodoSummaryWidget::configUpdated()
 {
-    qDeleteAll(mLabels);
-    mLabels.clear();
-
     KConfig config(QStringLiteral("kcmtodosummaryrc"));
     KConfigGroup group = config.group("Days");
-    int mDaysToGo = group.readEntry("DaysToShow", 7);
+    mDaysToGo = group.readEntry("DaysToShow", 7);
 
     group = config.group("Hide");
     mHideInProgress = group.readEntry("InProgress", false);
@@ -81,12 +101,20 @@ void TodoSummaryWidget::updateView()
     group = config.group("Groupware");
     mShowMineOnly = group.readEntry("ShowMineOnly", false);
 
-    // for each todo,
+    group = config.group("Refresh");
+    mRefreshScheduler->setDelay(group.readEntry("Delay", mRefreshScheduler->delay()));
+
+    updateView();
+}
+
+void TodoSummaryWidget::updateView()
+{
+    mRefreshScheduler->cancel();
+
+    // for each todo due soon enough,
     //   if it passes the filter, append to a list
     //   else continue
-    // sort todolist by summary
-    // sort todolist by priority
-    // sort todolist by due-date
+    // sort todolist by due-date, then priority, then summary
     // print todolist
 
     // the filter is created by the configuration summary options, but includes
@@ -96,38 +124,21 @@ void TodoSummaryWidget::updateView()
     KCalendarCore::Todo::List prList;
 
     const QDate currDate = QDate::currentDate();
-    const KCalendarCore::Todo::List todos = mCalendar->todos();
+    const KCalendarCore::Todo::List todos = mTodoIndex->todos(currDate.addDays(mDaysToGo), !mHideCompleted, !mHideOpenEnded);
     for (const KCalendarCore::Todo::Ptr &todo : todos) {
-        if (todo->hasDueDate()) {
-            const int daysTo = currDate.daysTo(todo->dtDue().date());
-            if (daysTo >= mDaysToGo) {
-                continue;
-            }
-        }
-
         if (mHideOverdue && todo->isOverdue()) {
             continue;
         }
         if (mHideInProgress && todo->isInProgress(false)) {
             continue;
         }
-        if (mHideCompleted && todo->isCompleted()) {
-            continue;
-        }
-        if (mHideOpenEnded && todo->isOpenEnded()) {
-            continue;
-        }
         if (mHideNotStarted && todo->isNotStarted(false)) {
             continue;
         }
 
         prList.append(todo);
     }
-    if (!prList.isEmpty()) {
-        prList = Akonadi::ETMCalendar::sortTodos(prList, KCalendarCore::TodoSortSummary, KCalendarCore::SortDirectionAscending);
-        prList = Akonadi::ETMCalendar::sortTodos(prList, KCalendarCore::TodoSortPriority, KCalendarCore::SortDirectionAscending);
-        prList = Akonadi::ETMCalendar::sortTodos(prList, KCalendarCore::TodoSortDueDate, KCalendarCore::SortDirectionAscending);
-    }
+    std::sort(prList.begin(), prList.end(), todoLessThan);
 
     // The to-do print consists of the following fields:
     //  icon:due date:days-to-go:priority:summary:status
@@ -144,11 +155,12 @@ void TodoSummaryWidget::updateView()
     //     complete (100% completed)
     //     open-ended
     //     not-started (no start date and 0% completed)
+    //
+    // The labels of the previous update are reused row by row, so only the
+    // rows which actually changed are touched.
 
     int counter = 0;
     if (!prList.isEmpty()) {
-        QPixmap pm = QIcon::fromTheme(QStringLiteral("view-calendar-tasks")).pixmap(style()->pixelMetric(QStyle::PM_SmallIconSize));
-
         QString str;
 
         for (const KCalendarCore::Todo::Ptr &todo : std::as_const(prList)) {
@@ -163,12 +175,10 @@ void TodoSummaryWidget::updateView()
             TODO: calhelper is deprecated, remove this?
             */
 
-            // Icon label
-            auto label = new QLabel(this);
-            label->setPixmap(pm);
-            label->setMaximumWidth(label->minimumSizeHint().width());
-            mLayout->addWidget(label, counter, 0);
-            mLabels.append(label);
+            if (counter == mRows.count()) {
+                mRows.append(createRow(counter));
+            }
+            const TodoRow &row = mRows.at(counter);
 
             // Due date label
             str.clear();
@@ -197,14 +207,11 @@ void TodoSummaryWidget::updateView()
                 }
             }
 
-            label = new QLabel(str, this);
-            label->setAlignment(Qt::AlignLeft | Qt::AlignVCenter);
-            mLayout->addWidget(label, counter, 1);
-            mLabels.append(label);
-            if (makeBold) {
-                QFont font = label->font();
-                font.setBold(true);
-                label->setFont(font);
+            row.dueDate->setText(str);
+            if (row.dueDate->font().bold() != makeBold) {
+                QFont font = row.dueDate->font();
+                font.setBold(makeBold);
+                row.dueDate->setFont(font);
             }
 
             // Days togo/ago label
@@ -218,17 +225,11 @@ void TodoSummaryWidget::updateView()
                     str = i18nc("the to-do is due", "due");
                 }
             }
-            label = new QLabel(str, this);
-            label->setAlignment(Qt::AlignLeft | Qt::AlignVCenter);
-            mLayout->addWidget(label, counter, 2);
-            mLabels.append(label);
+            row.daysToGo->setText(str);
 
             // Priority label
             str = QLatin1Char('[') + QString::number(todo->priority()) + QLatin1Char(']');
-            label = new QLabel(str, this);
-            label->setAlignment(Qt::AlignRight | Qt::AlignVCenter);
-            mLayout->addWidget(label, counter, 3);
-            mLabels.append(label);
+            row.priority->setText(str);
 
             // Summary label
             str = todo->summary();
@@ -241,44 +242,89 @@ void TodoSummaryWidget::updateView()
             if (!Qt::mightBeRichText(str)) {
                 str = str.toHtmlEscaped();
             }
+            row.summary->setText(str);
+            row.summary->setUrl(todo->uid());
 
-            auto urlLabel = new KUrlLabel(this);
-            urlLabel->setText(str);
-            urlLabel->setUrl(todo->uid());
-            urlLabel->installEventFilter(this);
-            urlLabel->setTextFormat(Qt::RichText);
-            urlLabel->setWordWrap(true);
-            mLayout->addWidget(urlLabel, counter, 4);
-            mLabels.append(urlLabel);
-            connect(urlLabel, &KUrlLabel::leftClickedUrl, this, [this, urlLabel] {
-                viewTodo(urlLabel->url());
-            });
-            connect(urlLabel, &KUrlLabel::rightClickedUrl, this, [this, urlLabel] {
-                popupMenu(urlLabel->url());
-            });
             // State text label
-            str = stateStr(todo);
-            label = new QLabel(str, this);
-            label->setAlignment(Qt::AlignLeft | Qt::AlignVCenter);
-            mLayout->addWidget(label, counter, 5);
-            mLabels.append(label);
+            row.state->setText(stateStr(todo));
 
             counter++;
         }
     } // foreach
 
-    if (counter == 0) {
-        auto noTodos = new QLabel(i18np("No pending to-dos due within the next day", "No pending to-dos due within the next %1 days", mDaysToGo), this);
-        noTodos->setAlignment(Qt::AlignHCenter | Qt::AlignVCenter);
-        mLayout->addWidget(noTodos, 0, 0);
-        mLabels.append(noTodos);
+    // drop the rows of to-dos which are gone
+    while (mRows.count() > counter) {
+        const TodoRow row = mRows.takeLast();
+        delete row.icon;
+        delete row.dueDate;
+        delete row.daysToGo;
+        delete row.priority;
+        delete row.summary;
+        delete row.state;
     }
 
-    for (QLabel *label : std::as_const(mLabels)) {
-        label->show();
+    if (counter == 0) {
+        if (!mNoTodosLabel) {
+            mNoTodosLabel = new QLabel(this);
+            mNoTodosLabel->setAlignment(Qt::AlignHCenter | Qt::AlignVCenter);
+            mLayout->addWidget(mNoTodosLabel, 0, 0);
+            mNoTodosLabel->show();
+        }
+        mNoTodosLabel->setText(i18np("No pending to-dos due within the next day", "No pending to-dos due within the next %1 days", mDaysToGo));
+    } else {
+        delete mNoTodosLabel;
+        mNoTodosLabel = nullptr;
     }
 }
 
+TodoSummaryWidget::TodoRow TodoSummaryWidget::createRow(int rowIndex)
+{
+    TodoRow row;
+
+    row.icon = new QLabel(this);
+    row.icon->setPixmap(QIcon::fromTheme(QStringLiteral("view-calendar-tasks")).pixmap(style()->pixelMetric(QStyle::PM_SmallIconSize)));
+    row.icon->setMaximumWidth(row.icon->minimumSizeHint().width());
+    mLayout->addWidget(row.icon, rowIndex, 0);
+
+    row.dueDate = new QLabel(this);
+    row.dueDate->setAlignment(Qt::AlignLeft | Qt::AlignVCenter);
+    mLayout->addWidget(row.dueDate, rowIndex, 1);
+
+    row.daysToGo = new QLabel(this);
+    row.daysToGo->setAlignment(Qt::AlignLeft | Qt::AlignVCenter);
+    mLayout->addWidget(row.daysToGo, rowIndex, 2);
+
+    row.priority = new QLabel(this);
+    row.priority->setAlignment(Qt::AlignRight | Qt::AlignVCenter);
+    mLayout->addWidget(row.priority, rowIndex, 3);
+
+    // the url is read when clicked, so the connections stay valid while the row is reused
+    auto urlLabel = new KUrlLabel(this);
+    urlLabel->installEventFilter(this);
+    urlLabel->setTextFormat(Qt::RichText);
+    urlLabel->setWordWrap(true);
+    mLayout->addWidget(urlLabel, rowIndex, 4);
+    connect(urlLabel, &KUrlLabel::leftClickedUrl, this, [this, urlLabel] {
+        viewTodo(urlLabel->url());
+    });
+    connect(urlLabel, &KUrlLabel::rightClickedUrl, this, [this, urlLabel] {
+        popupMenu(urlLabel->url());
+    });
+    row.summary = urlLabel;
+
+    row.state = new QLabel(this);
+    row.state->setAlignment(Qt::AlignLeft | Qt::AlignVCenter);
+    mLayout->addWidget(row.state, rowIndex, 5);
+
+    row.icon->show();
+    row.dueDate->show();
+    row.daysToGo->show();
+    row.priority->show();
+    row.summary->show();
+    row.state->show();
+    return row;
+}
+
 void TodoSummaryWidget::viewTodo(const QString &uid)
 {
     const Akonadi::Item::Id id = mCalendar->item(uid).id();
@@ -16,6 +16,10 @@
 #include <Akonadi/Calendar/ETMCalendar>
 #include <KontactInterface/Summary>
 
+#include <memory>
+
+class SummaryRefreshScheduler;
+class TodoDueIndex;
 class TodoPlugin;
 
 namespace Akonadi
@@ -23,6 +27,7 @@ namespace Akonadi
 class IncidenceChanger;
 }
 
+class KUrlLabel;
 class QGridLayout;
 class QLabel;
 
@@ -39,6 +44,8 @@ public:
         return 3;
     }
 
+    void configUpdated();
+
 public Q_SLOTS:
     void updateSummary(bool force = false) override
     {
@@ -57,10 +64,22 @@ private Q_SLOTS:
     void completeTodo(Akonadi::Item::Id id);
 
 private:
+    /** The labels showing one to-do. */
+    struct TodoRow {
+        QLabel *icon = nullptr;
+        QLabel *dueDate = nullptr;
+        QLabel *daysToGo = nullptr;
+        QLabel *priority = nullptr;
+        KUrlLabel *summary = nullptr;
+        QLabel *state = nullptr;
+    };
+
+    Q_REQUIRED_RESULT TodoRow createRow(int rowIndex);
+
     TodoPlugin *mPlugin = nullptr;
     QGridLayout *mLayout = nullptr;
 
-    bool mDaysToGo = false;
+    int mDaysToGo = 7;
     bool mHideInProgress = false;
     bool mHideOverdue = false;
     bool mHideCompleted = false;
@@ -68,9 +87,12 @@ private:
     bool mHideNotStarted = false;
     bool mShowMineOnly = false;
 
-    QList<QLabel *> mLabels;
+    QVector<TodoRow> mRows;
+    QLabel *mNoTodosLabel = nullptr;
     Akonadi::ETMCalendar::Ptr mCalendar;
+    std::unique_ptr<TodoDueIndex> mTodoIndex;
     Akonadi::IncidenceChanger *mChanger = nullptr;
+    SummaryRefreshScheduler *mRefreshScheduler = nullptr;
 
     /**
       Test if the To-do starts today.
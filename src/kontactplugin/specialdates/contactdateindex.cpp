@@ -0,0 +1,208 @@
+/*
+  This file is part of Kontact.
+
+  SPDX-FileCopyrightText: 2026 KOrganizer Developers
+
+  SPDX-License-Identifier: GPL-2.0-or-later WITH Qt-Commercial-exception-1.0
+*/
+
+#include "contactdateindex.h"
+#include "korganizer_kontactplugins_specialdates_debug.h"
+
+#include <Akonadi/CollectionFetchJob>
+#include <Akonadi/Contact/ContactParts>
+#include <Akonadi/CollectionFetchScope>
+#include <Akonadi/ItemFetchJob>
+#include <Akonadi/ItemFetchScope>
+#include <Akonadi/Monitor>
+
+// Sorts the dates of a year by month and day, regardless of the year
+static int dayKey(QDate date)
+{
+    return date.month() * 32 + date.day();
+}
+
+ContactDateIndex::ContactDateIndex(QObject *parent)
+    : QObject(parent)
+    , mMonitor(new Akonadi::Monitor(this))
+{
+    mMonitor->setObjectName(QStringLiteral("SpecialDatesContactMonitor"));
+    mMonitor->setMimeTypeMonitored(KContacts::Addressee::mimeType());
+    mMonitor->itemFetchScope().fetchPayloadPart(Akonadi::ContactPart::Standard);
+
+    connect(mMonitor, &Akonadi::Monitor::itemAdded, this, [this](const Akonadi::Item &item) {
+        insert(item);
+        if (mContacts.contains(item.id())) {
+            Q_EMIT changed();
+        }
+    });
+    connect(mMonitor, &Akonadi::Monitor::itemChanged, this, [this](const Akonadi::Item &item) {
+        const bool wasIndexed = remove(item.id());
+        insert(item);
+        if (wasIndexed || mContacts.contains(item.id())) {
+            Q_EMIT changed();
+        }
+    });
+    connect(mMonitor, &Akonadi::Monitor::itemRemoved, this, [this](const Akonadi::Item &item) {
+        if (remove(item.id())) {
+            Q_EMIT changed();
+        }
+    });
+
+    auto job = new Akonadi::CollectionFetchJob(Akonadi::Collection::root(), Akonadi::CollectionFetchJob::Recursive, this);
+    job->fetchScope().setContentMimeTypes({KContacts::Addressee::mimeType()});
+    connect(job, &Akonadi::CollectionFetchJob::result, this, &ContactDateIndex::slotCollectionsFetched);
+}
+
+ContactDateIndex::~ContactDateIndex() = default;
+
+bool ContactDateIndex::isLoaded() const
+{
+    return mLoaded;
+}
+
+Akonadi::Item ContactDateIndex::Contact::item() const
+{
+    Akonadi::Item item(id);
+    item.setMimeType(KContacts::Addressee::mimeType());
+    return item;
+}
+
+QVector<ContactDateIndex::Contact> ContactDateIndex::birthdays(QDate start, QDate end) const
+{
+    return lookup(mBirthdays, start, end);
+}
+
+QVector<ContactDateIndex::Contact> ContactDateIndex::anniversaries(QDate start, QDate end) const
+{
+    return lookup(mAnniversaries, start, end);
+}
+
+ContactDateIndex::Contact ContactDateIndex::contact(Akonadi::Item::Id id) const
+{
+    return mContacts.value(id);
+}
+
+QDate ContactDateIndex::anniversary(const KContacts::Addressee &addressee)
+{
+    return QDate::fromString(addressee.custom(QStringLiteral("KADDRESSBOOK"), QStringLiteral("X-Anniversary")), Qt::ISODate);
+}
+
+void ContactDateIndex::slotCollectionsFetched(KJob *job)
+{
+    if (job->error()) {
+        qCWarning(KORGANIZER_KONTACTPLUGINS_SPECIALDATES_LOG) << "Unable to fetch the address books:" << job->errorString();
+    }
+
+    const Akonadi::Collection::List collections = static_cast<Akonadi::CollectionFetchJob *>(job)->collections();
+    for (const Akonadi::Collection &collection : collections) {
+        if (!collection.contentMimeTypes().contains(KContacts::Addressee::mimeType())) {
+            continue;
+        }
+        auto fetchJob = new Akonadi::ItemFetchJob(collection, this);
+        fetchJob->fetchScope().fetchPayloadPart(Akonadi::ContactPart::Standard);
+        fetchJob->fetchScope().setIgnoreRetrievalErrors(true);
+        connect(fetchJob, &Akonadi::ItemFetchJob::result, this, &ContactDateIndex::slotItemsFetched);
+        ++mPendingJobs;
+    }
+
+    if (mPendingJobs == 0) {
+        mLoaded = true;
+        Q_EMIT changed();
+    }
+}
+
+void ContactDateIndex::slotItemsFetched(KJob *job)
+{
+    if (job->error()) {
+        qCWarning(KORGANIZER_KONTACTPLUGINS_SPECIALDATES_LOG) << "Unable to fetch the contacts:" << job->errorString();
+    }
+
+    const Akonadi::Item::List items = static_cast<Akonadi::ItemFetchJob *>(job)->items();
+    for (const Akonadi::Item &item : items) {
+        // the monitor may have delivered a newer revision already
+        if (!mContacts.contains(item.id())) {
+            insert(item);
+        }
+    }
+
+    if (--mPendingJobs == 0) {
+        mLoaded = true;
+        Q_EMIT changed();
+    }
+}
+
+void ContactDateIndex::insert(const Akonadi::Item &item)
+{
+    if (!item.hasPayload<KContacts::Addressee>()) {
+        return;
+    }
+
+    const auto addressee = item.payload<KContacts::Addressee>();
+    Contact contact;
+    contact.birthday = addressee.birthday().date();
+    contact.anniversary = anniversary(addressee);
+    if (!contact.birthday.isValid() && !contact.anniversary.isValid()) {
+        return;
+    }
+
+    contact.id = item.id();
+    contact.name = addressee.realName();
+    contact.fullEmail = addressee.fullEmail();
+    if (contact.birthday.isValid()) {
+        mBirthdays.insert(dayKey(contact.birthday), contact.id);
+    }
+    if (contact.anniversary.isValid()) {
+        mAnniversaries.insert(dayKey(contact.anniversary), contact.id);
+    }
+    mContacts.insert(contact.id, contact);
+}
+
+bool ContactDateIndex::remove(Akonadi::Item::Id id)
+{
+    const auto it = mContacts.find(id);
+    if (it == mContacts.end()) {
+        return false;
+    }
+
+    if (it->birthday.isValid()) {
+        mBirthdays.remove(dayKey(it->birthday), id);
+    }
+    if (it->anniversary.isValid()) {
+        mAnniversaries.remove(dayKey(it->anniversary), id);
+    }
+    mContacts.erase(it);
+    return true;
+}
+
+QVector<ContactDateIndex::Contact> ContactDateIndex::lookup(const QMultiMap<int, Akonadi::Item::Id> &map, QDate start, QDate end) const
+{
+    QVector<Contact> contacts;
+    if (end < start) {
+        return contacts;
+    }
+
+    auto collect = [&](int first, int last) {
+        const auto mapEnd = map.cend();
+        for (auto it = map.lowerBound(first); it != mapEnd && it.key() <= last; ++it) {
+            contacts.append(mContacts.value(it.value()));
+        }
+    };
+
+    // February 29 is celebrated on February 28 in other years
+    int lastKey = dayKey(end);
+    if (end.month() == 2 && end.day() == 28 && !QDate::isLeapYear(end.year())) {
+        ++lastKey;
+    }
+
+    if (start.daysTo(end) >= 365) {
+        collect(0, dayKey(QDate(2000, 12, 31)));
+    } else if (start.year() == end.year()) {
+        collect(dayKey(start), lastKey);
+    } else {
+        // the range wraps around the end of the year
+        collect(dayKey(start), dayKey(QDate(start.year(), 12, 31)));
+        collect(0, lastKey);
+    }
+    return contacts;
+}
@@ -0,0 +1,94 @@
+/*
+  This file is part of Kontact.
+
+  SPDX-FileCopyrightText: 2026 KOrganizer Developers
+
+  SPDX-License-Identifier: GPL-2.0-or-later WITH Qt-Commercial-exception-1.0
+*/
+#pragma once
+
+#include <Akonadi/Item>
+#include <KContacts/Addressee>
+
+#include <QDate>
+#include <QHash>
+#include <QMultiMap>
+#include <QObject>
+#include <QVector>
+
+class KJob;
+
+namespace Akonadi
+{
+class Monitor;
+}
+
+/**
+ * Indexes the birthdays and anniversaries of the contacts by day of the year,
+ * so that the special dates of a range of days can be looked up locally.
+ *
+ * The contacts are fetched once, when the index is created, and then kept up
+ * to date through the change notifications of an Akonadi::Monitor. Only the
+ * standard payload part is fetched, without photos, and only what the summary
+ * shows is kept, for the contacts which have a birthday or an anniversary.
+ */
+class ContactDateIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    /** The indexed details of a contact */
+    struct Contact {
+        Akonadi::Item::Id id = -1;
+        QString name;
+        QString fullEmail;
+        QDate birthday;
+        QDate anniversary;
+
+        /** Returns an item referring to the contact, without payload. */
+        Q_REQUIRED_RESULT Akonadi::Item item() const;
+    };
+
+    explicit ContactDateIndex(QObject *parent = nullptr);
+    ~ContactDateIndex() override;
+
+    /** Returns true once the initial fetch of the contacts has finished. */
+    Q_REQUIRED_RESULT bool isLoaded() const;
+
+    /**
+      Returns the contacts whose birthday falls between @p start and @p end, inclusive.
+      A February 29 birthday is also returned for a range ending on February 28.
+    */
+    Q_REQUIRED_RESULT QVector<Contact> birthdays(QDate start, QDate end) const;
+
+    /** Returns the contacts whose anniversary falls between @p start and @p end, inclusive. */
+    Q_REQUIRED_RESULT QVector<Contact> anniversaries(QDate start, QDate end) const;
+
+    /** Returns the indexed contact with item id @p id, or an invalid one if there is none. */
+    Q_REQUIRED_RESULT Contact contact(Akonadi::Item::Id id) const;
+
+    /** Returns the wedding anniversary of @p addressee, as stored by KAddressBook. */
+    Q_REQUIRED_RESULT static QDate anniversary(const KContacts::Addressee &addressee);
+
+Q_SIGNALS:
+    /** Emitted when the initial fetch has finished and whenever a special date changed. */
+    void changed();
+
+private:
+    void slotCollectionsFetched(KJob *job);
+    void slotItemsFetched(KJob *job);
+    void insert(const Akonadi::Item &item);
+    bool remove(Akonadi::Item::Id id);
+    QVector<Contact> lookup(const QMultiMap<int, Akonadi::Item::Id> &map, QDate start, QDate end) const;
+
+    Akonadi::Monitor *const mMonitor;
+
+    /** the indexed contacts, keyed by item id */
+    QHash<Akonadi::Item::Id, Contact> mContacts;
+    /** item ids, keyed by the month and day of the birthday */
+    QMultiMap<int, Akonadi::Item::Id> mBirthdays;
+    /** item ids, keyed by the month and day of the anniversary */
+    QMultiMap<int, Akonadi::Item::Id> mAnniversaries;
+    int mPendingJobs = 0;
+    bool mLoaded = false;
+};
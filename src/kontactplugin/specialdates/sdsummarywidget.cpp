@@ -9,19 +9,20 @@
 
 #include "sdsummarywidget.h"
 #include "korganizer_kontactplugins_specialdates_debug.h"
+#include "../korganizer/summaryrefreshscheduler.h"
+#include "contactdateindex.h"
 #include <KontactInterface/Core>
 #include <KontactInterface/Plugin>
 
-#include <Akonadi/Contact/ContactSearchJob>
 #include <Akonadi/Contact/ContactViewerDialog>
 #include <Akonadi/EntityDisplayAttribute>
 #include <Akonadi/ItemFetchJob>
 #include <Akonadi/ItemFetchScope>
-#include <Akonadi/SearchQuery>
 #include <CalendarSupport/CalendarSingleton>
 #include <CalendarSupport/Utils>
 
 #include <KCalendarCore/Calendar>
+#include <KCalendarCore/Recurrence>
 
 #include <KConfig>
 #include <KConfigGroup>
@@ -39,26 +40,6 @@
 
 using namespace KHolidays;
 
-class BirthdaySearchJob : public Akonadi::ItemSearchJob
-{
-    Q_OBJECT
-public:
-    explicit BirthdaySearchJob(QObject *parent, int daysInAdvance);
-};
-
-BirthdaySearchJob::BirthdaySearchJob(QObject *parent, int daysInAdvance)
-    : ItemSearchJob(parent)
-{
-    fetchScope().fetchFullPayload();
-    setMimeTypes({KContacts::Addressee::mimeType()});
-
-    Akonadi::SearchQuery query;
-    query.addTerm(QStringLiteral("birthday"), QDate::currentDate().toJulianDay(), Akonadi::SearchTerm::CondGreaterOrEqual);
-    query.addTerm(QStringLiteral("birthday"), QDate::currentDate().addDays(daysInAdvance).toJulianDay(), Akonadi::SearchTerm::CondLessOrEqual);
-
-    ItemSearchJob::setQuery(query);
-}
-
 enum SDIncidenceType { IncidenceTypeContact, IncidenceTypeEvent };
 
 enum SDCategory { CategoryBirthday, CategoryAnniversary, CategoryHoliday, CategorySeasonal, CategoryOther };
@@ -74,8 +55,8 @@ public:
     QString summary;
     QString desc;
     int span; // #days in the special occasion.
-    KContacts::Addressee addressee;
-    Akonadi::Item item;
+    QString name; // of the contact
+    Akonadi::Item item; // the contact, without payload
 
     bool operator<(const SDEntry &entry) const
     {
@@ -108,13 +89,14 @@ SDSummaryWidget::SDSummaryWidget(KontactInterface::Plugin *plugin, QWidget *pare
     mShowAnniversariesFromKAB = true;
     mShowAnniversariesFromCal = true;
     mShowHolidays = true;
-    mJobRunning = false;
     mShowSpecialsFromCal = true;
 
     // Setup the Addressbook
     connect(mPlugin->core(), &KontactInterface::Core::dayChanged, this, &SDSummaryWidget::updateView);
 
-    connect(mCalendar.data(), &Akonadi::ETMCalendar::calendarChanged, this, &SDSummaryWidget::updateView);
+    mRefreshScheduler = new SummaryRefreshScheduler(this);
+    connect(mRefreshScheduler, &SummaryRefreshScheduler::refresh, this, &SDSummaryWidget::updateView);
+    connect(mCalendar.data(), &Akonadi::ETMCalendar::calendarChanged, mRefreshScheduler, &SummaryRefreshScheduler::schedule);
 
     // Update Configuration
     configUpdated();
@@ -146,6 +128,9 @@ void SDSummaryWidget::configUpdated()
     group = config.group("Groupware");
     mShowMineOnly = group.readEntry("ShowMineOnly", false);
 
+    group = config.group("Refresh");
+    mRefreshScheduler->setDelay(group.readEntry("Delay", mRefreshScheduler->delay()));
+
     updateView();
 }
 
@@ -155,8 +140,10 @@ bool SDSummaryWidget::initHolidays()
     KConfigGroup hconfig(&_hconfig, "Time & Date");
     QString location = hconfig.readEntry("Holidays");
     if (!location.isEmpty()) {
-        delete mHolidays;
-        mHolidays = new HolidayRegion(location);
+        if (!mHolidays || mHolidays->regionCode() != location) {
+            delete mHolidays;
+            mHolidays = new HolidayRegion(location);
+        }
         return true;
     }
     return false;
@@ -196,38 +183,133 @@ int SDSummaryWidget::dayof(const KCalendarCore::Event::Ptr &event, const QDate &
     return dayof;
 }
 
-void SDSummaryWidget::slotBirthdayJobFinished(KJob *job)
+void SDSummaryWidget::addContactDates(const QDate &start, const QDate &end)
+{
+    auto addEntries = [this](const QVector<ContactDateIndex::Contact> &contacts, SDCategory category) {
+        for (const ContactDateIndex::Contact &contact : contacts) {
+            const QDate date = category == CategoryBirthday ? contact.birthday : contact.anniversary;
+            SDEntry entry;
+            entry.type = IncidenceTypeContact;
+            entry.category = category;
+            dateDiff(date, entry.daysTo, entry.yearsOld);
+            if (entry.daysTo < mDaysAhead) {
+                // The index works on days of the year, so check the days ahead
+                // for February 29 and for ranges spanning a year.
+                entry.date = date;
+                entry.name = contact.name;
+                entry.item = contact.item();
+                entry.span = 1;
+                mDates.append(entry);
+            }
+        }
+    };
+
+    if (mShowBirthdaysFromKAB) {
+        addEntries(mContactIndex->birthdays(start, end), CategoryBirthday);
+    }
+    if (mShowAnniversariesFromKAB) {
+        addEntries(mContactIndex->anniversaries(start, end), CategoryAnniversary);
+    }
+}
+
+void SDSummaryWidget::scanCalendarEvents(const QDate &start, const QDate &end)
 {
-    // ;)
-    auto bJob = qobject_cast<BirthdaySearchJob *>(job);
-    if (bJob) {
-        const auto items = bJob->items();
-        for (const Akonadi::Item &item : items) {
-            if (item.hasPayload<KContacts::Addressee>()) {
-                const auto addressee = item.payload<KContacts::Addressee>();
-                const QDate birthday = addressee.birthday().date();
-                if (birthday.isValid()) {
-                    SDEntry entry;
-                    entry.type = IncidenceTypeContact;
-                    entry.category = CategoryBirthday;
-                    dateDiff(birthday, entry.daysTo, entry.yearsOld);
-                    if (entry.daysTo < mDaysAhead) {
-                        // We need to check the days ahead here because we don't
-                        // filter out Contact Birthdays by mDaysAhead in createLabels().
-                        entry.date = birthday;
-                        entry.addressee = addressee;
-                        entry.item = item;
-                        entry.span = 1;
-                        mDates.append(entry);
+    // Returns the category of the first of the event's categories which is shown
+    auto classify = [this](const KCalendarCore::Event::Ptr &ev, SDCategory &category) {
+        const QStringList categories = ev->categories();
+        for (const QString &c : categories) {
+            if (mShowBirthdaysFromCal && c.compare(QLatin1String("BIRTHDAY"), Qt::CaseInsensitive) == 0) {
+                category = CategoryBirthday;
+                return true;
+            }
+            if (mShowAnniversariesFromCal && c.compare(QLatin1String("ANNIVERSARY"), Qt::CaseInsensitive) == 0) {
+                category = CategoryAnniversary;
+                return true;
+            }
+            if (mShowHolidays && c.compare(QLatin1String("HOLIDAY"), Qt::CaseInsensitive) == 0) {
+                category = CategoryHoliday;
+                return true;
+            }
+            if (mShowSpecialsFromCal && c.compare(QLatin1String("SPECIAL OCCASION"), Qt::CaseInsensitive) == 0) {
+                category = CategoryOther;
+                return true;
+            }
+        }
+        return false;
+    };
+
+    // A single query for the whole range, each event is classified once
+    // and then added for every day it occurs on.
+    const QTimeZone timeZone = mCalendar->timeZone();
+    const KCalendarCore::Event::List events = mCalendar->events(start, end, timeZone);
+    for (const KCalendarCore::Event::Ptr &ev : events) {
+        // Optionally, show only my Events
+        /* if ( mShowMineOnly &&
+                !KCalendarCore::CalHelper::isMyCalendarIncidence( mCalendarAdaptor, ev. ) ) {
+          // FIXME; does isMyCalendarIncidence work !? It's deprecated too.
+          continue;
+          }
+          // TODO: CalHelper is deprecated, remove this?
+          */
+
+        if (ev->customProperty("KABC", "BIRTHDAY") == QLatin1String("YES")) {
+            // Skipping, because these are got from the ContactDateIndex
+            // See comments in updateView()
+            continue;
+        }
+        if (mShowAnniversariesFromKAB && ev->customProperty("KABC", "ANNIVERSARY") == QLatin1String("YES")) {
+            // The birthdays agent's copy of an anniversary shown from the ContactDateIndex
+            continue;
+        }
+
+        SDCategory category;
+        if (!classify(ev, category)) {
+            continue;
+        }
+
+        SDEntry entry;
+        entry.type = IncidenceTypeEvent;
+        entry.category = category;
+        entry.summary = ev->summary();
+        entry.desc = ev->description();
+        const bool isAnniversary = category == CategoryBirthday || category == CategoryAnniversary;
+        if (isAnniversary) {
+            /* Duplicates of KABC birthdays with the same summary and date are
+             * not filtered out.
+             * FIXME: port to akonadi, it's kresource based
+             * */
+            dateDiff(ev->dtStart().date(), entry.daysTo, entry.yearsOld);
+            entry.span = 1;
+        } else {
+            entry.span = span(ev);
+        }
+
+        const QDate eventStart = ev->dtStart().toTimeZone(timeZone).date();
+        const qint64 length = qMax<qint64>(0, eventStart.daysTo(ev->dtEnd().toTimeZone(timeZone).date()));
+        KCalendarCore::DateTimeList occurrences;
+        if (ev->recurs()) {
+            occurrences = ev->recurrence()->timesInInterval(QDateTime(start.addDays(-length), QTime(0, 0), timeZone),
+                                                            QDateTime(end, QTime(23, 59, 59), timeZone));
+        } else {
+            occurrences.append(ev->dtStart());
+        }
+
+        for (const QDateTime &occurrence : std::as_const(occurrences)) {
+            const QDate first = occurrence.toTimeZone(timeZone).date();
+            const QDate last = qMin(first.addDays(length), end);
+            for (QDate dt = qMax(first, start); dt <= last; dt = dt.addDays(1)) {
+                if (!isAnniversary) {
+                    if (entry.span > 1 && dayof(ev, dt) > 1) { // skip days 2,3,...
+                        continue;
                     }
+                    dateDiff(dt, entry.daysTo, entry.yearsOld);
+                    entry.yearsOld = -1; // ignore age of holidays and special occasions
                 }
+                entry.date = dt;
+                mDates.append(entry);
             }
         }
-        // Carry on.
-        createLabels();
     }
-
-    mJobRunning = false;
 }
 
 void SDSummaryWidget::createLabels()
@@ -242,134 +324,36 @@ void SDSummaryWidget::createLabels()
     }
     mLabels.clear();
 
-    QDate dt;
-    for (dt = QDate::currentDate(); dt <= QDate::currentDate().addDays(mDaysAhead - 1); dt = dt.addDays(1)) {
-        const KCalendarCore::Event::List events =
-            mCalendar->events(dt, mCalendar->timeZone(), KCalendarCore::EventSortStartDate, KCalendarCore::SortDirectionAscending);
-        for (const KCalendarCore::Event::Ptr &ev : events) {
-            // Optionally, show only my Events
-            /* if ( mShowMineOnly &&
-                    !KCalendarCore::CalHelper::isMyCalendarIncidence( mCalendarAdaptor, ev. ) ) {
-              // FIXME; does isMyCalendarIncidence work !? It's deprecated too.
-              continue;
-              }
-              // TODO: CalHelper is deprecated, remove this?
-              */
-
-            if (ev->customProperty("KABC", "BIRTHDAY") == QLatin1String("YES")) {
-                // Skipping, because these are got by the BirthdaySearchJob
-                // See comments in updateView()
-                continue;
-            }
-
-            if (!ev->categoriesStr().isEmpty()) {
-                QStringList::ConstIterator it2;
-                const QStringList c = ev->categories();
-                QStringList::ConstIterator end(c.constEnd());
-                for (it2 = c.constBegin(); it2 != end; ++it2) {
-                    const QString itUpper((*it2).toUpper());
-                    // Append Birthday Event?
-                    if (mShowBirthdaysFromCal && (itUpper == QLatin1String("BIRTHDAY"))) {
-                        SDEntry entry;
-                        entry.type = IncidenceTypeEvent;
-                        entry.category = CategoryBirthday;
-                        entry.date = dt;
-                        entry.summary = ev->summary();
-                        entry.desc = ev->description();
-                        dateDiff(ev->dtStart().date(), entry.daysTo, entry.yearsOld);
-                        entry.span = 1;
-
-                        /* The following check is to prevent duplicate entries,
-                         * so in case of having a KCal incidence with category birthday
-                         * with summary and date equal to some KABC Attendee we don't show it
-                         * FIXME: port to akonadi, it's kresource based
-                         * */
-                        if (/*!check( bdayRes, dt, ev->summary() )*/ true) {
-                            mDates.append(entry);
-                        }
-                        break;
-                    }
-
-                    // Append Anniversary Event?
-                    if (mShowAnniversariesFromCal && (itUpper == QLatin1String("ANNIVERSARY"))) {
-                        SDEntry entry;
-                        entry.type = IncidenceTypeEvent;
-                        entry.category = CategoryAnniversary;
-                        entry.date = dt;
-                        entry.summary = ev->summary();
-                        entry.desc = ev->description();
-                        dateDiff(ev->dtStart().date(), entry.daysTo, entry.yearsOld);
-                        entry.span = 1;
-                        if (/*!check( annvRes, dt, ev->summary() )*/ true) {
-                            mDates.append(entry);
-                        }
-                        break;
-                    }
-
-                    // Append Holiday Event?
-                    if (mShowHolidays && (itUpper == QLatin1String("HOLIDAY"))) {
-                        SDEntry entry;
-                        entry.type = IncidenceTypeEvent;
-                        entry.category = CategoryHoliday;
-                        entry.date = dt;
-                        entry.summary = ev->summary();
-                        entry.desc = ev->description();
-                        dateDiff(dt, entry.daysTo, entry.yearsOld);
-                        entry.yearsOld = -1; // ignore age of holidays
-                        entry.span = span(ev);
-                        if (entry.span > 1 && dayof(ev, dt) > 1) { // skip days 2,3,...
-                            break;
-                        }
-                        mDates.append(entry);
-                        break;
-                    }
-
-                    // Append Special Occasion Event?
-                    if (mShowSpecialsFromCal && (itUpper == QLatin1String("SPECIAL OCCASION"))) {
-                        SDEntry entry;
-                        entry.type = IncidenceTypeEvent;
-                        entry.category = CategoryOther;
-                        entry.date = dt;
-                        entry.summary = ev->summary();
-                        entry.desc = ev->description();
-                        dateDiff(dt, entry.daysTo, entry.yearsOld);
-                        entry.yearsOld = -1; // ignore age of special occasions
-                        entry.span = span(ev);
-                        if (entry.span > 1 && dayof(ev, dt) > 1) { // skip days 2,3,...
-                            break;
-                        }
-                        mDates.append(entry);
-                        break;
-                    }
-                }
-            }
-        }
+    const QDate start = QDate::currentDate();
+    const QDate end = start.addDays(mDaysAhead - 1);
+    if (mContactIndex) {
+        addContactDates(start, end);
     }
+    scanCalendarEvents(start, end);
 
     // Search for Holidays
-    if (mShowHolidays) {
-        if (initHolidays()) {
-            for (dt = QDate::currentDate(); dt <= QDate::currentDate().addDays(mDaysAhead - 1); dt = dt.addDays(1)) {
-                QList<Holiday> holidays = mHolidays->holidays(dt);
-                QList<Holiday>::ConstIterator it = holidays.constBegin();
-                for (; it != holidays.constEnd(); ++it) {
-                    SDEntry entry;
-                    entry.type = IncidenceTypeEvent;
-                    if ((*it).categoryList().contains(QLatin1String("seasonal"))) {
-                        entry.category = CategorySeasonal;
-                    } else if ((*it).categoryList().contains(QLatin1String("public"))) {
-                        entry.category = CategoryHoliday;
-                    } else {
-                        entry.category = CategoryOther;
-                    }
-                    entry.date = dt;
-                    entry.summary = (*it).name();
-                    dateDiff(dt, entry.daysTo, entry.yearsOld);
-                    entry.yearsOld = -1; // ignore age of holidays
-                    entry.span = 1;
-
-                    mDates.append(entry);
-                }
+    if (mShowHolidays && initHolidays()) {
+        const Holiday::List holidays = mHolidays->holidays(start, end);
+        for (const Holiday &holiday : holidays) {
+            SDEntry entry;
+            entry.type = IncidenceTypeEvent;
+            if (holiday.categoryList().contains(QLatin1String("seasonal"))) {
+                entry.category = CategorySeasonal;
+            } else if (holiday.categoryList().contains(QLatin1String("public"))) {
+                entry.category = CategoryHoliday;
+            } else {
+                entry.category = CategoryOther;
+            }
+            entry.summary = holiday.name();
+            entry.span = 1;
+
+            // one entry per day, like for single day holidays
+            const QDate last = qMin(holiday.observedEndDate(), end);
+            for (QDate dt = qMax(holiday.observedStartDate(), start); dt <= last; dt = dt.addDays(1)) {
+                entry.date = dt;
+                dateDiff(dt, entry.daysTo, entry.yearsOld);
+                entry.yearsOld = -1; // ignore age of holidays
+                mDates.append(entry);
             }
         }
     }
@@ -379,6 +363,7 @@ void SDSummaryWidget::createLabels()
 
     if (!mDates.isEmpty()) {
         int counter = 0;
+        Akonadi::Item::List missingPhotos;
         QList<SDEntry>::Iterator addrIt;
         QList<SDEntry>::Iterator addrEnd(mDates.end());
         for (addrIt = mDates.begin(); addrIt != addrEnd; ++addrIt) {
@@ -387,31 +372,22 @@ void SDSummaryWidget::createLabels()
             // Pixmap
             QImage icon_img;
             QString icon_name;
-            KContacts::Picture pic;
+            if ((*addrIt).type == IncidenceTypeContact) {
+                const auto photo = mContactPhotos.constFind((*addrIt).item.id());
+                if (photo != mContactPhotos.cend()) {
+                    icon_img = *photo;
+                } else {
+                    // fetched only once, the result asks for a refresh
+                    mContactPhotos.insert((*addrIt).item.id(), QImage());
+                    missingPhotos.append((*addrIt).item);
+                }
+            }
             switch ((*addrIt).category) {
             case CategoryBirthday:
                 icon_name = QStringLiteral("view-calendar-birthday");
-                pic = (*addrIt).addressee.photo();
-                if (pic.isIntern() && !pic.data().isNull()) {
-                    QImage img = pic.data();
-                    if (img.width() > img.height()) {
-                        icon_img = img.scaledToWidth(32);
-                    } else {
-                        icon_img = img.scaledToHeight(32);
-                    }
-                }
                 break;
             case CategoryAnniversary:
                 icon_name = QStringLiteral("view-calendar-wedding-anniversary");
-                pic = (*addrIt).addressee.photo();
-                if (pic.isIntern() && !pic.data().isNull()) {
-                    QImage img = pic.data();
-                    if (img.width() > img.height()) {
-                        icon_img = img.scaledToWidth(32);
-                    } else {
-                        icon_img = img.scaledToHeight(32);
-                    }
-                }
                 break;
             case CategoryHoliday:
                 icon_name = QStringLiteral("view-calendar-holiday");
@@ -514,7 +490,7 @@ void SDSummaryWidget::createLabels()
                 auto urlLabel = new KUrlLabel(this);
                 urlLabel->installEventFilter(this);
                 urlLabel->setUrl((*addrIt).item.url(Akonadi::Item::UrlWithMimeType).url());
-                urlLabel->setText((*addrIt).addressee.realName());
+                urlLabel->setText((*addrIt).name);
                 urlLabel->setTextFormat(Qt::RichText);
                 urlLabel->setWordWrap(true);
                 mLayout->addWidget(urlLabel, counter, 4);
@@ -551,6 +527,10 @@ void SDSummaryWidget::createLabels()
 
             counter++;
         }
+
+        if (!missingPhotos.isEmpty()) {
+            fetchContactPhotos(missingPhotos);
+        }
     } else {
         auto label = new QLabel(i18np("No special dates within the next 1 day", "No special dates pending within the next %1 days", mDaysAhead), this);
         label->setAlignment(Qt::AlignHCenter | Qt::AlignVCenter);
@@ -568,36 +548,34 @@ void SDSummaryWidget::createLabels()
 
 void SDSummaryWidget::updateView()
 {
+    mRefreshScheduler->cancel();
     mDates.clear();
 
-    /* KABC Birthdays are got through a ItemSearchJob/SPARQL Query
-     * I then added an ETM/CalendarModel because we need to search
-     * for calendar entries that have birthday/anniversary categories too.
-     *
-     * Also, we can't get KABC Anniversaries through nepomuk because the
-     * current S.D.O doesn't support it, so i also them through the ETM.
+    /* KABC birthdays and anniversaries are looked up in a local index of the
+     * address books, which is kept up to date through change notifications.
+     * Calendar birthdays and anniversaries come from the ETM. The birthdays
+     * agent's copies of contact birthdays are skipped, and so are its copies
+     * of contact anniversaries while these are shown from the index.
      *
      * So basically we have:
      * Calendar anniversaries - ETM
      * Calendar birthdays - ETM
-     * KABC birthdays - BirthdaySearchJob
-     * KABC anniversaries - ETM ( needs Birthday Agent running )
-     *
-     * We could remove thomas' BirthdaySearchJob and use the ETM for that
-     * but it has the advantage that we don't need a Birthday agent running.
+     * KABC birthdays - ContactDateIndex
+     * KABC anniversaries - ContactDateIndex
      *
      **/
 
-    // Search for Birthdays
-    if (mShowBirthdaysFromKAB && !mJobRunning) {
-        auto job = new BirthdaySearchJob(this, mDaysAhead);
-
-        connect(job, &BirthdaySearchJob::result, this, &SDSummaryWidget::slotBirthdayJobFinished);
-        job->start();
-        mJobRunning = true;
-
-        // The result slot will trigger the rest of the update
+    if ((mShowBirthdaysFromKAB || mShowAnniversariesFromKAB) && !mContactIndex) {
+        // The index is filled asynchronously and asks for a refresh once loaded.
+        mContactIndex = new ContactDateIndex(this);
+        connect(mContactIndex, &ContactDateIndex::changed, this, [this]() {
+            // a changed contact may have a new photo as well
+            mContactPhotos.clear();
+            mRefreshScheduler->schedule();
+        });
     }
+
+    createLabels();
 }
 
 void SDSummaryWidget::mailContact(const QString &url)
@@ -608,11 +586,57 @@ void SDSummaryWidget::mailContact(const QString &url)
         return;
     }
 
+    // the index holds the address of the contacts it shows
+    if (mContactIndex) {
+        const ContactDateIndex::Contact contact = mContactIndex->contact(item.id());
+        if (contact.id == item.id()) {
+            QDesktopServices::openUrl(QUrl(contact.fullEmail));
+            return;
+        }
+    }
+
     auto job = new Akonadi::ItemFetchJob(item, this);
     job->fetchScope().fetchFullPayload();
     connect(job, &Akonadi::ItemFetchJob::result, this, &SDSummaryWidget::slotItemFetchJobDone);
 }
 
+void SDSummaryWidget::fetchContactPhotos(const Akonadi::Item::List &items)
+{
+    auto job = new Akonadi::ItemFetchJob(items, this);
+    job->fetchScope().fetchFullPayload();
+    job->fetchScope().setIgnoreRetrievalErrors(true);
+    connect(job, &Akonadi::ItemFetchJob::result, this, &SDSummaryWidget::slotPhotosFetched);
+}
+
+void SDSummaryWidget::slotPhotosFetched(KJob *job)
+{
+    if (job->error()) {
+        qCWarning(KORGANIZER_KONTACTPLUGINS_SPECIALDATES_LOG) << job->errorString();
+    }
+
+    bool found = false;
+    const Akonadi::Item::List items = qobject_cast<Akonadi::ItemFetchJob *>(job)->items();
+    for (const Akonadi::Item &item : items) {
+        if (!item.hasPayload<KContacts::Addressee>()) {
+            continue;
+        }
+        const KContacts::Picture pic = item.payload<KContacts::Addressee>().photo();
+        if (pic.isIntern() && !pic.data().isNull()) {
+            const QImage img = pic.data();
+            if (img.width() > img.height()) {
+                mContactPhotos.insert(item.id(), img.scaledToWidth(32));
+            } else {
+                mContactPhotos.insert(item.id(), img.scaledToHeight(32));
+            }
+            found = true;
+        }
+    }
+
+    if (found) {
+        mRefreshScheduler->schedule();
+    }
+}
+
 void SDSummaryWidget::slotItemFetchJobDone(KJob *job)
 {
     if (job->error()) {
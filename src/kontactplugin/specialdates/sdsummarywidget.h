@@ -12,8 +12,12 @@
 #include <KCalendarCore/Event>
 
 #include <Akonadi/Calendar/ETMCalendar>
+#include <Akonadi/Item>
 #include <KontactInterface/Summary>
 
+#include <QHash>
+#include <QImage>
+
 namespace KHolidays
 {
 class HolidayRegion;
@@ -27,7 +31,9 @@ class Plugin;
 class QDate;
 class QGridLayout;
 class QLabel;
+class ContactDateIndex;
 class SDEntry;
+class SummaryRefreshScheduler;
 class KJob;
 
 class SDSummaryWidget : public KontactInterface::Summary
@@ -53,13 +59,19 @@ private:
     void popupMenu(const QString &url);
     void mailContact(const QString &url);
     void viewContact(const QString &url);
-    void slotBirthdayJobFinished(KJob *job);
     void slotItemFetchJobDone(KJob *job);
+    /** Fetches the photos of the contacts @p items, which the index doesn't hold. */
+    void fetchContactPhotos(const Akonadi::Item::List &items);
+    void slotPhotosFetched(KJob *job);
 
     int span(const KCalendarCore::Event::Ptr &event) const;
     int dayof(const KCalendarCore::Event::Ptr &event, const QDate &date) const;
     Q_REQUIRED_RESULT bool initHolidays();
     void dateDiff(const QDate &date, int &days, int &years) const;
+    /** Adds the birthdays and anniversaries of the contacts between @p start and @p end to mDates. */
+    void addContactDates(const QDate &start, const QDate &end);
+    /** Adds the special dates of the calendar's events between @p start and @p end to mDates. */
+    void scanCalendarEvents(const QDate &start, const QDate &end);
     void createLabels();
 
     Akonadi::ETMCalendar::Ptr mCalendar;
@@ -67,6 +79,10 @@ private:
     QGridLayout *mLayout = nullptr;
     QList<QLabel *> mLabels;
     KontactInterface::Plugin *const mPlugin;
+    SummaryRefreshScheduler *mRefreshScheduler = nullptr;
+    ContactDateIndex *mContactIndex = nullptr;
+    /** the scaled photos of the shown contacts, null for contacts without one */
+    QHash<Akonadi::Item::Id, QImage> mContactPhotos;
 
     int mDaysAhead;
     bool mShowBirthdaysFromKAB = false;
@@ -76,7 +92,6 @@ private:
     bool mShowHolidays = false;
     bool mShowSpecialsFromCal = false;
     bool mShowMineOnly = false;
-    bool mJobRunning = false;
     QList<SDEntry> mDates;
 
     KHolidays::HolidayRegion *mHolidays = nullptr;
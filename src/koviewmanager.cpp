@@ -151,8 +151,12 @@ void KOViewManager::showView(KOrg::BaseView *view)
     }
 
     raiseCurrentView();
+    if (mConfigPendingViews.remove(mCurrentView)) {
+        mCurrentView->updateConfig();
+    }
     mMainView->processIncidenceSelection(Akonadi::Item(), QDate());
-    mMainView->updateView();
+    // the view is filled in once the switch has been handled
+    mMainView->updateView(EventViews::EventView::DatesChanged);
     KOrg::MainWindow *w = ActionManager::findInstance(QUrl());
 
     if (w) {
@@ -277,11 +281,30 @@ void KOViewManager::connectView(KOrg::BaseView *view)
             mMainView, qOverload<const Akonadi::Item &>(&CalendarView::newSubTodo));
     connect(view, &BaseView::newJournalSignal, mMainView, qOverload<const QDate &>(&CalendarView::newJournal));
 
-    // reload settings
-    connect(mMainView, &CalendarView::configChanged, view, &KOrg::BaseView::updateConfig);
+    // reload settings; a hidden view catches up when showView() raises it
+    connect(mMainView, &CalendarView::configChanged, view, [this, view]() {
+        if (view != mCurrentView && mViews.contains(view)) {
+            mConfigPendingViews.insert(view);
+        } else {
+            view->updateConfig();
+        }
+    });
+    connect(view, &QObject::destroyed, this, [this, view]() {
+        mConfigPendingViews.remove(view);
+        mDayPassedPendingViews.remove(view);
+    });
+
+    // a hidden view catches up on the day change when it is shown, see eventFilter()
+    connect(mMainView, &CalendarView::dayPassed, view, [this, view](const QDate &date) {
+        if (view->isVisible()) {
+            view->dayPassed(date);
+        } else {
+            mDayPassedPendingViews.insert(view);
+        }
+    });
+    view->installEventFilter(this);
 
     // Notifications about added, changed and deleted incidences
-    connect(mMainView, &CalendarView::dayPassed, view, &BaseView::dayPassed);
     connect(view, &BaseView::startMultiModify, mMainView, &CalendarView::startMultiModify);
     connect(view, &BaseView::endMultiModify, mMainView, &CalendarView::endMultiModify);
 
@@ -594,6 +617,18 @@ void KOViewManager::addChange(EventViews::EventView::Change change)
     }
 }
 
+bool KOViewManager::eventFilter(QObject *watched, QEvent *event)
+{
+    // only the views are watched
+    if (event->type() == QEvent::Show) {
+        auto view = static_cast<KOrg::BaseView *>(watched);
+        if (mDayPassedPendingViews.remove(view)) {
+            view->dayPassed(QDate::currentDate());
+        }
+    }
+    return QObject::eventFilter(watched, event);
+}
+
 void KOViewManager::updateMultiCalendarDisplay()
 {
     if (agendaIsSelected()) {
@@ -15,6 +15,7 @@
 
 #include <QDate>
 #include <QObject>
+#include <QSet>
 
 class CalendarView;
 class KOAgendaView;
@@ -155,9 +156,14 @@ public Q_SLOTS:
        Notifies all views that an update is needed. This means that the
        next time CalendarView::updateView() is called, views won't try to be smart
        and ignore the update for performance reasons.
+       Views which aren't shown only record the change; they are brought up to
+       date by showView().
     */
     void addChange(EventViews::EventView::Change change);
 
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
 private Q_SLOTS:
     void currentAgendaViewTabChanged(int index);
 
@@ -177,6 +183,10 @@ private:
     KOrg::BaseView *mCurrentView = nullptr;
 
     KOrg::BaseView *mLastEventView = nullptr;
+    // views which were hidden when the configuration changed
+    QSet<KOrg::BaseView *> mConfigPendingViews;
+    // views which were hidden when the day changed
+    QSet<KOrg::BaseView *> mDayPassedPendingViews;
     QTabWidget *mAgendaViewTabs = nullptr;
     int mAgendaViewTabIndex = 0;
 
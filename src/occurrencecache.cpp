@@ -0,0 +1,84 @@
+/*
+  This file is part of KOrganizer.
+
+  SPDX-FileCopyrightText: 2026 KOrganizer Developers
+
+  SPDX-License-Identifier: GPL-2.0-or-later WITH Qt-Commercial-exception-1.0
+*/
+
+#include "occurrencecache.h"
+
+#include <algorithm>
+
+OccurrenceCache::OccurrenceCache() = default;
+
+OccurrenceCache::~OccurrenceCache()
+{
+    if (mCalendar) {
+        mCalendar->unregisterObserver(this);
+    }
+}
+
+void OccurrenceCache::setCalendar(const Akonadi::ETMCalendar::Ptr &calendar)
+{
+    if (mCalendar) {
+        mCalendar->unregisterObserver(this);
+    }
+
+    mCalendar = calendar;
+    if (mCalendar) {
+        mCalendar->registerObserver(this);
+    }
+    clear();
+}
+
+void OccurrenceCache::setExpansionRange(const QDate &start, const QDate &end)
+{
+    mRangeStart = QDateTime(start, {}, Qt::LocalTime);
+    mRangeEnd = QDateTime(end, {}, Qt::LocalTime);
+}
+
+KCalendarCore::DateTimeList
+OccurrenceCache::timesInInterval(const KCalendarCore::Incidence::Ptr &incidence, const QDateTime &start, const QDateTime &end)
+{
+    const QString identifier = incidence->instanceIdentifier();
+    auto it = mExpansions.find(identifier);
+    if (it == mExpansions.end() || it->start > start || it->end < end) {
+        Expansion expansion;
+        expansion.start = start;
+        expansion.end = end;
+        if (mRangeStart.isValid() && mRangeEnd.isValid()) {
+            expansion.start = qMin(start, mRangeStart);
+            expansion.end = qMax(end, mRangeEnd);
+        }
+        expansion.times = incidence->recurrence()->timesInInterval(expansion.start, expansion.end);
+        it = mExpansions.insert(identifier, expansion);
+    }
+
+    // timesInInterval() returns the occurrences sorted
+    const KCalendarCore::DateTimeList &times = it->times;
+    const auto first = std::lower_bound(times.cbegin(), times.cend(), start);
+    const auto last = std::upper_bound(first, times.cend(), end);
+    return KCalendarCore::DateTimeList(first, last);
+}
+
+void OccurrenceCache::clear()
+{
+    mExpansions.clear();
+}
+
+void OccurrenceCache::calendarIncidenceAdded(const KCalendarCore::Incidence::Ptr &incidence)
+{
+    mExpansions.remove(incidence->instanceIdentifier());
+}
+
+void OccurrenceCache::calendarIncidenceChanged(const KCalendarCore::Incidence::Ptr &incidence)
+{
+    mExpansions.remove(incidence->instanceIdentifier());
+}
+
+void OccurrenceCache::calendarIncidenceDeleted(const KCalendarCore::Incidence::Ptr &incidence, const KCalendarCore::Calendar *calendar)
+{
+    Q_UNUSED(calendar)
+    mExpansions.remove(incidence->instanceIdentifier());
+}
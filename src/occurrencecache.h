@@ -0,0 +1,77 @@
+/*
+  This file is part of KOrganizer.
+
+  SPDX-FileCopyrightText: 2026 KOrganizer Developers
+
+  SPDX-License-Identifier: GPL-2.0-or-later WITH Qt-Commercial-exception-1.0
+*/
+
+#pragma once
+
+#include <Akonadi/Calendar/ETMCalendar>
+
+#include <QDateTime>
+#include <QHash>
+
+/**
+ * Caches the expanded occurrences of recurring incidences so that several
+ * day matrices showing overlapping months share a single expansion pass.
+ *
+ * Each incidence is expanded once over the expansion range, which the owner
+ * sets to the span of all matrices. Lookups for intervals inside that range
+ * are answered from the cached, sorted occurrence list.
+ *
+ * The cache observes the calendar and drops the entry of an incidence as
+ * soon as it is changed or deleted. It has to be registered with the calendar
+ * before the matrices using it, so that they never read stale occurrences
+ * from their own observer callbacks.
+ */
+class OccurrenceCache : public Akonadi::ETMCalendar::CalendarObserver
+{
+public:
+    OccurrenceCache();
+    ~OccurrenceCache() override;
+
+    /**
+      Associate a calendar with this cache. Clears all cached occurrences.
+    */
+    void setCalendar(const Akonadi::ETMCalendar::Ptr &calendar);
+
+    /**
+      Sets the range which incidences are expanded over. Entries not covering
+      the new range are re-expanded the next time they are looked up.
+    */
+    void setExpansionRange(const QDate &start, const QDate &end);
+
+    /**
+      Returns the occurrences of the recurring @p incidence in the interval
+      [@p start, @p end], like KCalendarCore::Recurrence::timesInInterval().
+    */
+    Q_REQUIRED_RESULT KCalendarCore::DateTimeList timesInInterval(const KCalendarCore::Incidence::Ptr &incidence,
+                                                                  const QDateTime &start,
+                                                                  const QDateTime &end);
+
+    /** Drops all cached occurrences. */
+    void clear();
+
+    void calendarIncidenceAdded(const KCalendarCore::Incidence::Ptr &incidence) override;
+    void calendarIncidenceChanged(const KCalendarCore::Incidence::Ptr &incidence) override;
+    void calendarIncidenceDeleted(const KCalendarCore::Incidence::Ptr &incidence, const KCalendarCore::Calendar *calendar) override;
+
+private:
+    struct Expansion {
+        QDateTime start;
+        QDateTime end;
+        KCalendarCore::DateTimeList times;
+    };
+
+    Akonadi::ETMCalendar::Ptr mCalendar;
+
+    /** range incidences are expanded over */
+    QDateTime mRangeStart;
+    QDateTime mRangeEnd;
+
+    /** cached expansions, keyed by the incidence's instance identifier */
+    QHash<QString, Expansion> mExpansions;
+};
+
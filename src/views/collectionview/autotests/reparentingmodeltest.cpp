@@ -163,6 +163,7 @@ private Q_SLOTS:
     void testAddRemoveSourceItem();
     void testInsertSourceRow();
     void testInsertSourceRowSubnode();
+    void testInsertRemoveSourceRowBlock();
     void testAddRemoveProxyNode();
     void testDeduplicate();
     void testDeduplicateNested();
@@ -170,6 +171,7 @@ private Q_SLOTS:
     void testNestedDeduplicateProxyNodeFirst();
     void testUpdateNode();
     void testReparent();
+    void testReparentKeepsSourceOrder();
     void testReparentSubcollections();
     void testReparentResetWithoutCrash();
     void testAddReparentedSourceItem();
@@ -178,10 +180,13 @@ private Q_SLOTS:
     void testAddNestedReparentedSourceItem();
     void testSourceDataChanged();
     void testSourceLayoutChanged();
+    void testSourceLayoutChangedOrder();
     void testInvalidLayoutChanged();
     void testAddRemoveNodeByNodeManager();
     void testRemoveNodeByNodeManagerWithDataChanged();
     void testDataChanged();
+    void benchmarkMapFromSource_data();
+    void benchmarkMapFromSource();
 };
 
 void ReparentingModelTest::testPopulation()
@@ -252,6 +257,32 @@ void ReparentingModelTest::testInsertSourceRow()
     QCOMPARE(row2->data(Qt::DisplayRole).toString(), QStringLiteral("row2foo"));
 }
 
+// Ensure a block of source rows is inserted and removed with a single signal
+void ReparentingModelTest::testInsertRemoveSourceRowBlock()
+{
+    QStandardItemModel sourceModel;
+    sourceModel.appendRow(new QStandardItem(QStringLiteral("row1")));
+
+    ReparentingModel reparentingModel;
+    reparentingModel.setSourceModel(&sourceModel);
+    ModelSignalSpy spy(reparentingModel);
+
+    QVERIFY(sourceModel.insertRows(1, 3));
+    QCOMPARE(reparentingModel.rowCount(QModelIndex()), 4);
+    QCOMPARE(spy.mSignals, QStringList() << QStringLiteral("rowsInserted"));
+    QCOMPARE(spy.parent, QModelIndex());
+    QCOMPARE(spy.start, 1);
+    QCOMPARE(spy.end, 3);
+
+    QVERIFY(sourceModel.removeRows(1, 3));
+    QCOMPARE(reparentingModel.rowCount(QModelIndex()), 1);
+    QVERIFY(getIndex("row1", reparentingModel).isValid());
+    QCOMPARE(spy.mSignals, QStringList() << QStringLiteral("rowsInserted") << QStringLiteral("rowsRemoved"));
+    QCOMPARE(spy.parent, QModelIndex());
+    QCOMPARE(spy.start, 1);
+    QCOMPARE(spy.end, 3);
+}
+
 // Ensure the model can deal with rows that are inserted out of order in a subnode
 void ReparentingModelTest::testInsertSourceRowSubnode()
 {
@@ -437,6 +468,29 @@ void ReparentingModelTest::testReparent()
     QCOMPARE(reparentingModel.rowCount(getIndex("proxy1", reparentingModel)), 1);
 }
 
+// Adopted source nodes keep the order of the source model
+void ReparentingModelTest::testReparentKeepsSourceOrder()
+{
+    QStandardItemModel sourceModel;
+    for (int i = 0; i < 50; ++i) {
+        sourceModel.appendRow(new QStandardItem(QStringLiteral("orphan%1").arg(i)));
+    }
+
+    ReparentingModel reparentingModel;
+    reparentingModel.setSourceModel(&sourceModel);
+
+    reparentingModel.addNode(ReparentingModel::Node::Ptr(new DummyNode(reparentingModel, QStringLiteral("proxy1"))));
+
+    QTest::qWait(0);
+
+    const QModelIndex proxyIndex = getIndex("proxy1", reparentingModel);
+    QVERIFY(proxyIndex.isValid());
+    QCOMPARE(reparentingModel.rowCount(proxyIndex), 50);
+    for (int i = 0; i < 50; ++i) {
+        QCOMPARE(reparentingModel.index(i, 0, proxyIndex).data().toString(), QStringLiteral("orphan%1").arg(i));
+    }
+}
+
 void ReparentingModelTest::testReparentSubcollections()
 {
     QStandardItemModel sourceModel;
@@ -651,6 +705,40 @@ void ReparentingModelTest::testSourceLayoutChanged()
     QCOMPARE(index2.data().toString(), QStringLiteral("row1"));
 }
 
+// Ensure a layout change reorders the nodes without rebuilding them
+void ReparentingModelTest::testSourceLayoutChangedOrder()
+{
+    QStandardItemModel sourceModel;
+    auto parent = new QStandardItem(QStringLiteral("parent"));
+    parent->appendRow(new QStandardItem(QStringLiteral("sub2")));
+    parent->appendRow(new QStandardItem(QStringLiteral("sub1")));
+    sourceModel.appendRow(new QStandardItem(QStringLiteral("row2")));
+    sourceModel.appendRow(parent);
+
+    QSortFilterProxyModel filter;
+    filter.setSourceModel(&sourceModel);
+
+    ReparentingModel reparentingModel;
+    reparentingModel.setSourceModel(&filter);
+    ModelSignalSpy spy(reparentingModel);
+
+    const QPersistentModelIndex parentIndex = getIndex("parent", reparentingModel);
+    const QPersistentModelIndex subIndex = getIndex("sub2", reparentingModel);
+    QCOMPARE(parentIndex.row(), 1);
+    QCOMPARE(subIndex.row(), 0);
+
+    filter.sort(0, Qt::AscendingOrder);
+
+    QCOMPARE(spy.mSignals, QStringList() << QStringLiteral("layoutChanged"));
+    QCOMPARE(reparentingModel.index(0, 0, QModelIndex()).data().toString(), QStringLiteral("parent"));
+    QCOMPARE(reparentingModel.index(1, 0, QModelIndex()).data().toString(), QStringLiteral("row2"));
+    QCOMPARE(parentIndex.row(), 0);
+    QCOMPARE(parentIndex.data().toString(), QStringLiteral("parent"));
+    QCOMPARE(subIndex.row(), 1);
+    QCOMPARE(subIndex.data().toString(), QStringLiteral("sub2"));
+    QCOMPARE(subIndex.parent(), QModelIndex(parentIndex));
+}
+
 /*
  * This is a very implementation specific test that tries to crash the model
  */
@@ -781,6 +869,47 @@ void ReparentingModelTest::testDataChanged()
     QCOMPARE(spy.mSignals, QStringList() << QStringLiteral("dataChanged"));
 }
 
+void ReparentingModelTest::benchmarkMapFromSource_data()
+{
+    QTest::addColumn<int>("folders");
+
+    QTest::newRow("100 folders") << 100;
+    QTest::newRow("1000 folders") << 1000;
+    QTest::newRow("5000 folders") << 5000;
+}
+
+// Mapping all nodes of a tree should scale linearly with the number of nodes
+void ReparentingModelTest::benchmarkMapFromSource()
+{
+    QFETCH(int, folders);
+
+    QStandardItemModel sourceModel;
+    for (int i = 0; i < folders; ++i) {
+        auto folder = new QStandardItem(QStringLiteral("folder%1").arg(i));
+        for (int j = 0; j < 10; ++j) {
+            folder->appendRow(new QStandardItem(QStringLiteral("subfolder%1-%2").arg(i).arg(j)));
+        }
+        sourceModel.appendRow(folder);
+    }
+
+    ReparentingModel reparentingModel;
+    reparentingModel.setSourceModel(&sourceModel);
+    QCOMPARE(reparentingModel.rowCount(QModelIndex()), folders);
+
+    QBENCHMARK {
+        for (int i = 0; i < folders; ++i) {
+            const QModelIndex folder = sourceModel.index(i, 0);
+            const QModelIndex proxyFolder = reparentingModel.mapFromSource(folder);
+            QCOMPARE(proxyFolder.row(), i);
+            for (int j = 0; j < 10; ++j) {
+                const QModelIndex proxyIndex = reparentingModel.mapFromSource(sourceModel.index(j, 0, folder));
+                QCOMPARE(proxyIndex.row(), j);
+                QCOMPARE(proxyIndex.parent(), proxyFolder);
+            }
+        }
+    }
+}
+
 QTEST_MAIN(ReparentingModelTest)
 
 #include "reparentingmodeltest.moc"
@@ -27,6 +27,29 @@ StyledCalendarDelegate::StyledCalendarDelegate(QObject *parent)
 
 StyledCalendarDelegate::~StyledCalendarDelegate() = default;
 
+void StyledCalendarDelegate::invalidateColor(Akonadi::Collection::Id id)
+{
+    mColors.remove(id);
+}
+
+void StyledCalendarDelegate::clearColors()
+{
+    mColors.clear();
+}
+
+QColor StyledCalendarDelegate::color(const Akonadi::Collection &collection) const
+{
+    auto it = mColors.constFind(collection.id());
+    if (it == mColors.cend()) {
+        QColor color = KOHelper::resourceColorKnown(collection);
+        if (!color.isValid()) {
+            color = KOHelper::resourceColor(collection);
+        }
+        it = mColors.insert(collection.id(), color);
+    }
+    return it.value();
+}
+
 static QRect enableButtonRect(QRect rect, int pos = 1)
 {
     // 2px border on each side of the icon
@@ -118,10 +141,7 @@ void StyledCalendarDelegate::paint(QPainter *painter, const QStyleOptionViewItem
 
     // Color indicator
     if (opt.checkState) {
-        QColor color = KOHelper::resourceColorKnown(col);
-        if (!color.isValid()) {
-            color = KOHelper::resourceColor(col);
-        }
+        QColor color = this->color(col);
         if (color.isValid()) {
             painter->save();
             painter->setRenderHint(QPainter::Antialiasing);
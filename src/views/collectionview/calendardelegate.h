@@ -6,6 +6,9 @@
 
 #pragma once
 
+#include <Akonadi/Collection>
+
+#include <QHash>
 #include <QStyledItemDelegate>
 
 class StyledCalendarDelegate : public QStyledItemDelegate
@@ -21,6 +24,11 @@ public:
 
     enum Action { Quickview, Total };
 
+    /** Forgets the cached color of the collection @p id, e.g. because the collection changed. */
+    void invalidateColor(Akonadi::Collection::Id id);
+    /** Forgets all cached colors, e.g. because the color configuration changed. */
+    void clearColors();
+
 Q_SIGNALS:
     void action(const QModelIndex &, int);
 
@@ -29,6 +37,9 @@ protected:
 
 private:
     QList<Action> getActions(const QStyleOptionViewItem &option, const QModelIndex &index) const;
+    QColor color(const Akonadi::Collection &collection) const;
     QHash<Action, QIcon> mIcon;
+    /** resource colors, keyed by collection id */
+    mutable QHash<Akonadi::Collection::Id, QColor> mColors;
 };
 
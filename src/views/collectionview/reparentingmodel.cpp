@@ -8,6 +8,8 @@
 
 #include "korganizer_debug.h"
 
+#include <algorithm>
+
 /*
  * Notes:
  * * layoutChanged must never add or remove nodes.
@@ -28,15 +30,21 @@ ReparentingModel::Node::Node(ReparentingModel &model, ReparentingModel::Node *p,
     , mIsSourceNode(true)
 {
     if (sourceIndex.isValid()) {
-        personModel.mSourceNodes.append(this);
+        mSourceOrder = personModel.mNextSourceOrder++;
+        personModel.mSourceNodes.insert(sourceIndex, this);
     }
     Q_ASSERT(parent);
 }
 
 ReparentingModel::Node::~Node()
 {
-    // The source index may be invalid meanwhile (it's a persistent index)
-    personModel.mSourceNodes.removeOne(this);
+    // The source index may be invalid meanwhile, but a persistent index keeps its identity
+    if (mIsSourceNode) {
+        const auto it = personModel.mSourceNodes.find(sourceIndex);
+        if (it != personModel.mSourceNodes.end() && it.value() == this) {
+            personModel.mSourceNodes.erase(it);
+        }
+    }
 }
 
 bool ReparentingModel::Node::operator==(const ReparentingModel::Node &node) const
@@ -49,16 +57,11 @@ ReparentingModel::Node::Ptr ReparentingModel::Node::searchNode(ReparentingModel:
     Node::Ptr nodePtr;
     if (node->parent) {
         // Reparent node
-        QVector<Node::Ptr>::iterator it = node->parent->children.begin();
-        for (; it != node->parent->children.end(); ++it) {
-            if (it->data() == node) {
-                // Reuse smart pointer
-                nodePtr = *it;
-                node->parent->children.erase(it);
-                break;
-            }
-        }
-        Q_ASSERT(nodePtr);
+        const int row = node->row();
+        Q_ASSERT(row >= 0);
+        // Reuse smart pointer
+        nodePtr = node->parent->children.at(row);
+        node->parent->children.remove(row);
     } else {
         nodePtr = Node::Ptr(node);
     }
@@ -119,14 +122,19 @@ bool ReparentingModel::Node::isSourceNode() const
 int ReparentingModel::Node::row() const
 {
     Q_ASSERT(parent);
-    int row = 0;
-    for (const Node::Ptr &node : std::as_const(parent->children)) {
-        if (node.data() == this) {
-            return row;
+    const QVector<Node::Ptr> &siblings = parent->children;
+    if (mRow >= 0 && mRow < siblings.size() && siblings.at(mRow).data() == this) {
+        return mRow;
+    }
+    // The cached row is stale, renumber all siblings at once
+    int result = -1;
+    for (int row = 0; row < siblings.size(); ++row) {
+        siblings.at(row)->mRow = row;
+        if (siblings.at(row).data() == this) {
+            result = row;
         }
-        row++;
     }
-    return -1;
+    return result;
 }
 
 ReparentingModel::ReparentingModel(QObject *parent)
@@ -175,13 +183,7 @@ bool ReparentingModel::validateNode(const Node *node) const
             return false;
         }
 
-        bool found = false;
-        for (const Node::Ptr &child : std::as_const(n->parent->children)) {
-            if (child.data() == n) {
-                found = true;
-            }
-        }
-        if (!found) {
+        if (n->row() < 0) {
             qCWarning(KORGANIZER_LOG) << "not linked as child" << depth;
             return false;
         }
@@ -408,10 +410,9 @@ QModelIndexList ReparentingModel::descendants(const QModelIndex &sourceIndex)
     return list;
 }
 
-void ReparentingModel::removeDuplicates(const QModelIndex &sourceIndex)
+void ReparentingModel::removeDuplicates(const QModelIndexList &subtree)
 {
-    const QModelIndexList list = QModelIndexList() << sourceIndex << descendants(sourceIndex);
-    for (const QModelIndex &descendant : list) {
+    for (const QModelIndex &descendant : subtree) {
         for (const Node::Ptr &proxyNode : std::as_const(mProxyNodes)) {
             if (proxyNode->isDuplicateOf(descendant)) {
                 // Removenode from proxy
@@ -430,9 +431,43 @@ void ReparentingModel::removeDuplicates(const QModelIndex &sourceIndex)
     }
 }
 
+bool ReparentingModel::affectsProxyNodes(const QModelIndexList &subtree) const
+{
+    for (const Node::Ptr &proxyNode : std::as_const(mProxyNodes)) {
+        if (!proxyNode->parent) {
+            continue;
+        }
+        for (int i = 0; i < subtree.size(); ++i) {
+            // The first index is the inserted one, its parent has been determined already
+            if (proxyNode->isDuplicateOf(subtree.at(i)) || (i > 0 && proxyNode->adopts(subtree.at(i)))) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
 void ReparentingModel::onSourceRowsInserted(const QModelIndex &parent, int start, int end)
 {
     // qCDebug(KORGANIZER_LOG) << objectName() << parent << start << end;
+
+    // Consecutive rows which neither replace proxy nodes nor have reparented
+    // descendants are inserted as a single block
+    Node *blockParent = nullptr;
+    QModelIndexList block;
+    auto flushBlock = [&]() {
+        if (block.isEmpty()) {
+            return;
+        }
+        const int targetRow = blockParent->children.size();
+        beginInsertRows(index(blockParent), targetRow, targetRow + block.size() - 1);
+        for (const QModelIndex &sourceIndex : std::as_const(block)) {
+            appendSourceNode(blockParent, sourceIndex);
+        }
+        endInsertRows();
+        block.clear();
+    };
+
     for (int row = start; row <= end; row++) {
         QModelIndex sourceIndex = sourceModel()->index(row, 0, parent);
         Q_ASSERT(sourceIndex.isValid());
@@ -444,22 +479,35 @@ void ReparentingModel::onSourceRowsInserted(const QModelIndex &parent, int start
         }
         Q_ASSERT(parentNode);
 
+        QModelIndexList subtree;
+        if (!mProxyNodes.isEmpty()) {
+            subtree << sourceIndex << descendants(sourceIndex);
+        }
+        if (subtree.isEmpty() || !affectsProxyNodes(subtree)) {
+            if (parentNode != blockParent) {
+                flushBlock();
+                blockParent = parentNode;
+            }
+            block << sourceIndex;
+            continue;
+        }
+        flushBlock();
+        blockParent = nullptr;
+
         // Remove any duplicates that we are going to replace
-        removeDuplicates(sourceIndex);
+        removeDuplicates(subtree);
 
         QModelIndexList reparented;
         // Check for children to reparent
-        {
-            const auto descendantsItem = descendants(sourceIndex);
-            for (const QModelIndex &descendant : descendantsItem) {
-                if (Node *proxyNode = getReparentNode(descendant)) {
-                    qCDebug(KORGANIZER_LOG) << "reparenting " << descendant.data().toString();
-                    int targetRow = proxyNode->children.size();
-                    beginInsertRows(index(proxyNode), targetRow, targetRow);
-                    appendSourceNode(proxyNode, descendant);
-                    reparented << descendant;
-                    endInsertRows();
-                }
+        for (int i = 1; i < subtree.size(); ++i) {
+            const QModelIndex &descendant = subtree.at(i);
+            if (Node *proxyNode = getReparentNode(descendant)) {
+                qCDebug(KORGANIZER_LOG) << "reparenting " << descendant.data().toString();
+                int targetRow = proxyNode->children.size();
+                beginInsertRows(index(proxyNode), targetRow, targetRow);
+                appendSourceNode(proxyNode, descendant);
+                reparented << descendant;
+                endInsertRows();
             }
         }
 
@@ -475,11 +523,27 @@ void ReparentingModel::onSourceRowsInserted(const QModelIndex &parent, int start
             endInsertRows();
         }
     }
+    flushBlock();
 }
 
 void ReparentingModel::onSourceRowsAboutToBeRemoved(const QModelIndex &parent, int start, int end)
 {
     // qCDebug(KORGANIZER_LOG) << objectName() << parent << start << end;
+
+    // Nodes which are adjacent below the same parent are removed as a single block
+    Node *blockParent = nullptr;
+    int blockFirst = -1;
+    int blockLast = -1;
+    auto flushBlock = [&]() {
+        if (!blockParent) {
+            return;
+        }
+        beginRemoveRows(index(blockParent), blockFirst, blockLast);
+        blockParent->children.remove(blockFirst, blockLast - blockFirst + 1); // deletes nodes
+        endRemoveRows();
+        blockParent = nullptr;
+    };
+
     // we remove in reverse order as otherwise the indexes in parentNode->children wouldn't be correct
     for (int row = end; row >= start; row--) {
         QModelIndex sourceIndex = sourceModel()->index(row, 0, parent);
@@ -492,11 +556,17 @@ void ReparentingModel::onSourceRowsAboutToBeRemoved(const QModelIndex &parent, i
             Node *parentNode = node->parent;
             Q_ASSERT(parentNode);
             const int targetRow = node->row();
-            beginRemoveRows(index(parentNode), targetRow, targetRow);
-            parentNode->children.remove(targetRow); // deletes node
-            endRemoveRows();
+            if (parentNode == blockParent && targetRow == blockFirst - 1) {
+                blockFirst = targetRow;
+            } else {
+                flushBlock();
+                blockParent = parentNode;
+                blockFirst = blockLast = node->row();
+            }
         }
     }
+    flushBlock();
+
     // Allows the node manager to remove nodes that are no longer relevant
     for (int row = start; row <= end; row++) {
         mNodeManager->checkSourceIndexRemoval(sourceModel()->index(row, 0, parent));
@@ -531,42 +601,51 @@ void ReparentingModel::onSourceRowsMoved(const QModelIndex & /* sourceParent */,
 
 void ReparentingModel::onSourceLayoutAboutToBeChanged()
 {
-    // layoutAboutToBeChanged();
-    // Q_FOREACH(const QModelIndex &proxyPersistentIndex, persistentIndexList()) {
-    //     Q_ASSERT(proxyPersistentIndex.isValid());
-    //     const QPersistentModelIndex srcPersistentIndex = mapToSource(proxyPersistentIndex);
-    //     // TODO also update the proxy persistent indexes
-    //     //Skip indexes that are not in the source model
-    //     if (!srcPersistentIndex.isValid()) {
-    //         continue;
-    //     }
-    //     mLayoutChangedProxyIndexes << proxyPersistentIndex;
-    //     mLayoutChangedSourcePersistentModelIndexes << srcPersistentIndex;
-    // }
+    Q_EMIT layoutAboutToBeChanged();
+    mLayoutChangedProxyIndexes = persistentIndexList();
 }
 
 void ReparentingModel::onSourceLayoutChanged()
 {
-    // By ignoring this we miss structural changes in the sourcemodel, which is mostly ok.
-    // Before we can re-enable this we need to properly deal with skipped duplicates, because
-    // a layout change MUST NOT add/remove new nodes (only shuffling allowed)
-    //
-    // Our source indexes are not endagered since we use persistend model indexes anyways
+    // A layout change MUST NOT add/remove nodes (only shuffling allowed), so we
+    // keep the node tree and only reorder it like the source model. Our source
+    // indexes are not endangered since we use persistent model indexes anyways.
+    sortSourceNodes(&mRootNode);
 
-    // rebuildAll();
-
-    // for (int i = 0; i < mLayoutChangedProxyIndexes.size(); ++i) {
-    //     const QModelIndex oldProxyIndex = mLayoutChangedProxyIndexes.at(i);
-    //     const QModelIndex newProxyIndex = mapFromSource(mLayoutChangedSourcePersistentModelIndexes.at(i));
-    //     if (oldProxyIndex != newProxyIndex) {
-    //         changePersistentIndex(oldProxyIndex, newProxyIndex);
-    //     }
-    // }
+    for (const QModelIndex &oldProxyIndex : std::as_const(mLayoutChangedProxyIndexes)) {
+        Node *node = static_cast<Node *>(oldProxyIndex.internalPointer());
+        const QModelIndex newProxyIndex = createIndex(node->row(), oldProxyIndex.column(), node);
+        if (oldProxyIndex != newProxyIndex) {
+            changePersistentIndex(oldProxyIndex, newProxyIndex);
+        }
+    }
+    mLayoutChangedProxyIndexes.clear();
 
-    // mLayoutChangedProxyIndexes.clear();
-    // mLayoutChangedSourcePersistentModelIndexes.clear();
+    Q_EMIT layoutChanged();
+}
 
-    // layoutChanged();
+void ReparentingModel::sortSourceNodes(Node *node)
+{
+    // Only the children which are below their source parent follow the source order,
+    // proxy nodes and reparented nodes keep their positions.
+    const QModelIndex sourceParent = node->isSourceNode() ? QModelIndex(node->sourceIndex) : QModelIndex();
+    const bool keepsSourceChildren = node == &mRootNode || node->isSourceNode();
+    QVector<int> positions;
+    QVector<Node::Ptr> sourceChildren;
+    for (int i = 0; i < node->children.size(); ++i) {
+        const Node::Ptr &child = node->children.at(i);
+        if (keepsSourceChildren && child->isSourceNode() && child->sourceIndex.isValid() && child->sourceIndex.parent() == sourceParent) {
+            positions << i;
+            sourceChildren << child;
+        }
+        sortSourceNodes(child.data());
+    }
+    std::stable_sort(sourceChildren.begin(), sourceChildren.end(), [](const Node::Ptr &lhs, const Node::Ptr &rhs) {
+        return lhs->sourceIndex.row() < rhs->sourceIndex.row();
+    });
+    for (int i = 0; i < positions.size(); ++i) {
+        node->children[positions.at(i)] = sourceChildren.at(i);
+    }
 }
 
 void ReparentingModel::onSourceDataChanged(const QModelIndex &begin, const QModelIndex &end)
@@ -634,13 +713,21 @@ QModelIndex ReparentingModel::mapToSource(const QModelIndex &idx) const
 
 ReparentingModel::Node *ReparentingModel::getSourceNode(const QModelIndex &sourceIndex) const
 {
+    // qCDebug(KORGANIZER_LOG) << objectName() <<  "no node found for " << sourceIndex;
+    return mSourceNodes.value(QPersistentModelIndex(sourceIndex), nullptr);
+}
+
+QVector<ReparentingModel::Node *> ReparentingModel::orderedSourceNodes() const
+{
+    QVector<Node *> nodes;
+    nodes.reserve(mSourceNodes.size());
     for (Node *n : std::as_const(mSourceNodes)) {
-        if (n->sourceIndex == sourceIndex) {
-            return n;
-        }
+        nodes.append(n);
     }
-    // qCDebug(KORGANIZER_LOG) << objectName() <<  "no node found for " << sourceIndex;
-    return nullptr;
+    std::sort(nodes.begin(), nodes.end(), [](const Node *lhs, const Node *rhs) {
+        return lhs->mSourceOrder < rhs->mSourceOrder;
+    });
+    return nodes;
 }
 
 QModelIndex ReparentingModel::mapFromSource(const QModelIndex &sourceIndex) const
@@ -695,8 +782,9 @@ void ReparentingModel::insertProxyNode(const Node::Ptr &proxyNode)
 
 void ReparentingModel::reparentSourceNodes(const Node::Ptr &proxyNode)
 {
-    // Reparent source nodes according to the provided rules
-    for (Node *n : std::as_const(mSourceNodes)) {
+    // Reparent source nodes according to the provided rules, in a stable order so siblings keep theirs
+    const QVector<Node *> sourceNodes = orderedSourceNodes();
+    for (Node *n : sourceNodes) {
         if (proxyNode->adopts(n->sourceIndex)) {
             // qCDebug(KORGANIZER_LOG) << "reparenting" << n->data(Qt::DisplayRole).toString() << "from" << n->parent->data(Qt::DisplayRole).toString()
             //         << "to" << proxyNode->data(Qt::DisplayRole).toString();
@@ -785,14 +873,7 @@ int ReparentingModel::row(ReparentingModel::Node *node) const
         return -1;
     }
     Q_ASSERT(validateNode(node));
-    int row = 0;
-    for (const Node::Ptr &c : std::as_const(node->parent->children)) {
-        if (c.data() == node) {
-            return row;
-        }
-        row++;
-    }
-    return -1;
+    return node->row();
 }
 
 QModelIndex ReparentingModel::index(Node *node) const
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <QAbstractProxyModel>
+#include <QHash>
 #include <QSharedPointer>
 #include <QVector>
 
@@ -47,6 +48,10 @@ public:
         Node *parent = nullptr;
         ReparentingModel &personModel;
         const bool mIsSourceNode = false;
+        /** the last known position in parent->children, verified on use */
+        mutable int mRow = -1;
+        /** when the source node was created, to walk source nodes in a stable order */
+        quint64 mSourceOrder = 0;
     };
 
     struct NodeManager {
@@ -133,13 +138,20 @@ private:
     Node *extractNode(const QModelIndex &index) const;
     void appendSourceNode(Node *parentNode, const QModelIndex &sourceIndex, const QModelIndexList &skip = QModelIndexList());
     QModelIndexList descendants(const QModelIndex &sourceIndex);
-    void removeDuplicates(const QModelIndex &sourceIndex);
+    void removeDuplicates(const QModelIndexList &subtree);
+    /** Returns whether inserting @p subtree replaces a proxy node or reparents one of its descendants. */
+    bool affectsProxyNodes(const QModelIndexList &subtree) const;
+    void sortSourceNodes(Node *node);
     Node *getSourceNode(const QModelIndex &sourceIndex) const;
+    /** Returns the source nodes in the order they were created. */
+    QVector<Node *> orderedSourceNodes() const;
 
     Node mRootNode;
-    QList<Node *> mSourceNodes;
+    QHash<QPersistentModelIndex, Node *> mSourceNodes;
+    quint64 mNextSourceOrder = 0;
     QVector<Node::Ptr> mProxyNodes;
     QVector<Node::Ptr> mNodesToAdd;
     NodeManager::Ptr mNodeManager;
+    QModelIndexList mLayoutChangedProxyIndexes;
 };
 
@@ -88,12 +88,19 @@ void KDateNavigator::setCalendar(const Akonadi::ETMCalendar::Ptr &calendar)
     mCalendar = calendar;
 
     if (mCalendar) {
-        connect(mCalendar.data(), &Akonadi::ETMCalendar::calendarChanged, this, &KDateNavigator::setUpdateNeeded);
+        // the day matrix keeps its incidence index current through the calendar
+        // observer interface, so only a repaint is needed here
+        connect(mCalendar.data(), &Akonadi::ETMCalendar::calendarChanged, mDayMatrix, qOverload<>(&QWidget::update));
     }
 
     mDayMatrix->setCalendar(calendar);
 }
 
+void KDateNavigator::setOccurrenceCache(OccurrenceCache *cache)
+{
+    mDayMatrix->setOccurrenceCache(cache);
+}
+
 void KDateNavigator::setBaseDate(const QDate &date)
 {
     if (date != mBaseDate) {
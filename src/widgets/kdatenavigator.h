@@ -16,6 +16,7 @@
 
 class KODayMatrix;
 class NavigatorBar;
+class OccurrenceCache;
 
 namespace Akonadi
 {
@@ -36,6 +37,11 @@ public:
     */
     void setCalendar(const Akonadi::ETMCalendar::Ptr &);
 
+    /**
+      Share recurrence expansions with other navigators. See KODayMatrix::setOccurrenceCache().
+    */
+    void setOccurrenceCache(OccurrenceCache *cache);
+
     void setBaseDate(const QDate &);
 
     Q_REQUIRED_RESULT KCalendarCore::DateList selectedDates() const